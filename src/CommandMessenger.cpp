@@ -5,11 +5,13 @@
 //
 
 #include "mobiflight.h"
+#include "IOCore.h"
 
 #include "Button.h"
 #include "Encoder.h"
 #if MF_ANALOG_SUPPORT == 1
 #include "Analog.h"
+#include "AnalogMux.h"
 #endif
 #if MF_INPUT_SHIFTER_SUPPORT == 1
 #include "InputShifter.h"
@@ -32,6 +34,10 @@
 #endif
 #if MF_DIGIN_MUX_SUPPORT == 1
 #include "DigInMux.h"
+#include "DigInMuxCascade.h"
+#endif
+#if MF_KEYMATRIX_SUPPORT == 1
+#include "KeyMatrix.h"
 #endif
 #if MF_CUSTOMDEVICE_SUPPORT == 1
 #include "CustomDevice.h"
@@ -68,11 +74,13 @@ void attachCommandCallbacks()
 
 #if MF_SERVO_SUPPORT == 1
     cmdMessenger.attach(kSetServo, Servos::OnSet);
+    cmdMessenger.attach(kSetServoSpeedAccel, Servos::OnSetSpeedAccel);
 #endif
 
     cmdMessenger.attach(kGetInfo, OnGetInfo);
     cmdMessenger.attach(kGetConfig, OnGetConfig);
     cmdMessenger.attach(kSetConfig, OnSetConfig);
+    cmdMessenger.attach(kSetConfigChunk, OnSetConfigChunk);
     cmdMessenger.attach(kResetConfig, OnResetConfig);
     cmdMessenger.attach(kSaveConfig, OnSaveConfig);
     cmdMessenger.attach(kActivateConfig, OnActivateConfig);
@@ -80,6 +88,9 @@ void attachCommandCallbacks()
     cmdMessenger.attach(kGenNewSerial, OnGenNewSerial);
     cmdMessenger.attach(kTrigger, OnTrigger);
     cmdMessenger.attach(kSetPowerSavingMode, OnSetPowerSavingMode);
+    cmdMessenger.attach(kSetTaskTiming, OnSetTaskTiming);
+    cmdMessenger.attach(kTaskStats, OnGetTaskStats);
+    cmdMessenger.attach(kMemoryStats, OnGetMemoryStats);
 
 #if MF_LCD_SUPPORT == 1
     cmdMessenger.attach(kSetLcdDisplayI2C, LCDDisplay::OnSet);
@@ -87,6 +98,11 @@ void attachCommandCallbacks()
 
 #if MF_OUTPUT_SHIFTER_SUPPORT == 1
     cmdMessenger.attach(kSetShiftRegisterPins, OutputShifter::OnSet);
+    cmdMessenger.attach(kSetShiftRegisterMask, OutputShifter::OnSetMask);
+#endif
+
+#if MF_INPUT_SHIFTER_SUPPORT == 1
+    cmdMessenger.attach(kSetInputShifterCompact, InputShifter::OnSetCompactEvents);
 #endif
 
 #if MF_CUSTOMDEVICE_SUPPORT == 1
@@ -135,7 +151,8 @@ uint32_t getLastCommandMillis()
     return lastCommand;
 }
 
-void OnTrigger()
+// the inputs are read on the 2nd core with IO_ON_2ND_CORE, so they are also triggered there
+void triggerInputs(uint8_t = 0, uint8_t = 0, uint8_t = 0, uint8_t = 0)
 {
     Button::OnTrigger();
 #if MF_INPUT_SHIFTER_SUPPORT == 1
@@ -143,9 +160,25 @@ void OnTrigger()
 #endif
 #if MF_DIGIN_MUX_SUPPORT == 1
     DigInMux::OnTrigger();
+    DigInMuxCascade::OnTrigger();
+#endif
+#if MF_KEYMATRIX_SUPPORT == 1
+    KeyMatrix::OnTrigger();
 #endif
 #if MF_ANALOG_SUPPORT == 1
     Analog::OnTrigger();
+    AnalogMux::OnTrigger();
+#endif
+}
+
+void OnTrigger()
+{
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    IOCore::call((1 << kTaskButtons) | (1 << kTaskInputShifters) | (1 << kTaskDigInMux) | (1 << kTaskDigInMuxCascade) |
+                     (1 << kTaskKeyMatrix) | (1 << kTaskAnalog) | (1 << kTaskAnalogMux),
+                 triggerInputs);
+#else
+    triggerInputs();
 #endif
 }
 
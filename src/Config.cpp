@@ -9,12 +9,14 @@
 #include "Button.h"
 #include "Encoder.h"
 #include "Output.h"
+#include "IOCore.h"
 #if !defined(ARDUINO_ARCH_AVR)
 #include "ArduinoUniqueID.h"
 #endif
 
 #if MF_ANALOG_SUPPORT == 1
 #include "Analog.h"
+#include "AnalogMux.h"
 #endif
 #if MF_INPUT_SHIFTER_SUPPORT == 1
 #include "InputShifter.h"
@@ -34,11 +36,12 @@
 #if MF_OUTPUT_SHIFTER_SUPPORT == 1
 #include "OutputShifter.h"
 #endif
-#if MF_MUX_SUPPORT == 1
-#include "MFMuxDriver.h"
-#endif
 #if MF_DIGIN_MUX_SUPPORT == 1
 #include "DigInMux.h"
+#include "DigInMuxCascade.h"
+#endif
+#if MF_KEYMATRIX_SUPPORT == 1
+#include "KeyMatrix.h"
 #endif
 #if MF_CUSTOMDEVICE_SUPPORT == 1
 #include "CustomDevice.h"
@@ -57,16 +60,20 @@ const char CustomDeviceConfig[] PROGMEM = {};
 
 MFEEPROM MFeeprom;
 
-#if MF_MUX_SUPPORT == 1
-extern MFMuxDriver MUX;
-#endif
-
 const uint8_t MEM_OFFSET_NAME   = 0;
 const uint8_t MEM_LEN_NAME      = 48;
 const uint8_t MEM_OFFSET_SERIAL = MEM_OFFSET_NAME + MEM_LEN_NAME;
 const uint8_t MEM_LEN_SERIAL    = 11;
 const uint8_t MEM_OFFSET_CONFIG = MEM_OFFSET_NAME + MEM_LEN_NAME + MEM_LEN_SERIAL;
 
+// The config is stored behind a header with length and CRC. The marker is 0xFF like an erased EEPROM,
+// so older firmwares treat it as "no config" instead of parsing it. Configs without header (NUL terminated,
+// starting at MEM_OFFSET_CONFIG) are still loaded.
+const uint8_t CONFIG_HEADER_MARKER  = 0xFF;
+const uint8_t CONFIG_HEADER_ID      = 'C';
+const uint8_t CONFIG_HEADER_VERSION = 1;
+const uint8_t CONFIG_HEADER_SIZE    = 7; // marker, id, version, length (2 bytes), CRC (2 bytes)
+
 #if defined(ARDUINO_ARCH_AVR)
 char serial[11]; // 3 characters for "SN-",7 characters for "xyz-zyx" plus terminating NULL
 #else
@@ -76,15 +83,21 @@ char           name[MEM_LEN_NAME]              = MOBIFLIGHT_NAME;
 const int      MEM_LEN_CONFIG                  = MEMLEN_CONFIG;
 char           nameBuffer[MEMLEN_NAMES_BUFFER] = "";
 uint16_t       configLengthEEPROM              = 0;
+uint16_t       configStartEEPROM               = MEM_OFFSET_CONFIG + CONFIG_HEADER_SIZE;
+uint16_t       configCrcEEPROM                 = 0xFFFF; // CRC of the uploaded config
+bool           configChunksUploaded            = false;  // kSaveConfig has to check length and CRC
 boolean        configActivated                 = false;
 uint16_t       pNameBuffer                     = 0; // pointer for nameBuffer during reading of config
+uint16_t       nameEnd[kTypeMax]               = {0}; // end of the names in nameBuffer per device group
+uint16_t       deviceCrc[kTypeMax]             = {0}; // CRC of the config entries per device group of the active devices
+bool           devicesBuilt                    = false; // deviceCrc[] is valid
 const uint16_t configLengthFlash               = sizeof(CustomDeviceConfig);
 bool boardReady                                = false;
 
 void resetConfig();
 void readConfig();
 void _activateConfig();
-void readConfigFromMemory(bool configFromFlash);
+bool readConfigFromMemory(bool configFromFlash, uint32_t groups);
 
 bool configStoredInFlash()
 {
@@ -103,18 +116,75 @@ bool getBoardReady()
 // ************************************************************
 // configBuffer handling
 // ************************************************************
-// reads the EEPROM until NUL terminator and returns the number of characters incl. terminator, starting from given address
+// CRC-16/CCITT, polynom 0x1021
+uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint16_t crc16Config(uint16_t crc, uint16_t adr, uint16_t len, bool configFromFlash)
+{
+    uint8_t buffer[32];
+    while (len) {
+        uint16_t chunk = len < sizeof(buffer) ? len : sizeof(buffer);
+        if (configFromFlash)
+            memcpy_P(buffer, CustomDeviceConfig + adr, chunk);
+        else
+            MFeeprom.read_block(adr, buffer, chunk);
+        crc = crc16(crc, buffer, chunk);
+        adr += chunk;
+        len -= chunk;
+    }
+    return crc;
+}
+
+// writes the header for the uploaded config, called before committing
+void writeConfigHeader()
+{
+    uint8_t header[CONFIG_HEADER_SIZE] = {CONFIG_HEADER_MARKER, CONFIG_HEADER_ID, CONFIG_HEADER_VERSION,
+                                          (uint8_t)(configLengthEEPROM & 0xFF), (uint8_t)(configLengthEEPROM >> 8),
+                                          (uint8_t)(configCrcEEPROM & 0xFF), (uint8_t)(configCrcEEPROM >> 8)};
+    MFeeprom.write_block(MEM_OFFSET_CONFIG, header, CONFIG_HEADER_SIZE);
+}
+
+// reads the config header and checks the CRC of the config, sets start and length of the config
+// configs without header are NUL terminated, so the EEPROM is read until NUL terminator
 bool readconfigLengthEEPROM()
 {
-    uint16_t addreeprom = MEM_OFFSET_CONFIG;
-    uint16_t length     = MFeeprom.get_length();
-    configLengthEEPROM  = 0;
+    uint8_t  header[CONFIG_HEADER_SIZE];
+    uint16_t length    = MFeeprom.get_length();
+    configLengthEEPROM = 0;
 
-    if (MFeeprom.read_byte(MEM_OFFSET_CONFIG) == 0xFF)
-        return false;
+    MFeeprom.read_block(MEM_OFFSET_CONFIG, header, CONFIG_HEADER_SIZE);
+    if (header[0] == CONFIG_HEADER_MARKER) {
+        // erased EEPROM or a header from a newer firmware
+        if (header[1] != CONFIG_HEADER_ID || header[2] != CONFIG_HEADER_VERSION)
+            return false;
+        uint16_t configLength = header[3] | (header[4] << 8);
+        uint16_t crc          = header[5] | (header[6] << 8);
+        if (configLength == 0)
+            return false;
+        if (configLength + 1 > MEM_LEN_CONFIG - CONFIG_HEADER_SIZE || crc16Config(0xFFFF, MEM_OFFSET_CONFIG + CONFIG_HEADER_SIZE, configLength, false) != crc) {
+            cmdMessenger.sendCmd(kStatus, F("Config corrupted"));
+            return false;
+        }
+        configStartEEPROM  = MEM_OFFSET_CONFIG + CONFIG_HEADER_SIZE;
+        configLengthEEPROM = configLength;
+        return true;
+    }
+
+    uint16_t addreeprom = MEM_OFFSET_CONFIG;
+    configStartEEPROM   = MEM_OFFSET_CONFIG;
     while (MFeeprom.read_byte(addreeprom++) != 0x00) {
         configLengthEEPROM++;
         if (addreeprom > length) {
+            configLengthEEPROM = 0;
             cmdMessenger.sendCmd(kStatus, F("Loading config failed")); // text or "-1" like config upload?
             return false;
         }
@@ -132,6 +202,26 @@ void loadConfig()
     _activateConfig();
 }
 
+// saves a received part of the config behind the already received parts
+bool storeConfigChunk(const char *cfg, uint16_t cfgLen)
+{
+    if (configLengthEEPROM + cfgLen + 1 >= MEM_LEN_CONFIG - CONFIG_HEADER_SIZE)
+        return false;
+#if defined(ARDUINO_ARCH_AVR)
+    // the EEPROM gets written immediately, so invalidate the stored config until the
+    // new one is completely saved. On the RP2040 nothing reaches the flash before
+    // OnSaveConfig() writes the new header and commits, the last saved config is
+    // kept if the upload gets aborted.
+    if (configLengthEEPROM == 0)
+        writeConfigHeader();
+#endif
+    // save the received config string including the terminatung NULL (+1) to EEPROM
+    MFeeprom.write_block(configStartEEPROM + configLengthEEPROM, cfg, cfgLen + 1);
+    configCrcEEPROM = crc16(configCrcEEPROM, (const uint8_t *)cfg, cfgLen);
+    configLengthEEPROM += cfgLen;
+    return true;
+}
+
 void OnSetConfig()
 {
 #ifdef DEBUG2CMDMESSENGER
@@ -142,15 +232,11 @@ void OnSetConfig()
     // If no config is in EEPROM, the config from flash will be used if available
     // This ensures backwards compatibility if a board gets updated with a config in flash
     // but also have a user config in EEPROM
-    char   *cfg    = cmdMessenger.readStringArg();
-    uint8_t cfgLen = strlen(cfg);
+    char    *cfg    = cmdMessenger.readStringArg();
+    uint16_t cfgLen = strlen(cfg);
 
     if (!configStoredInFlash()) {
-        bool maxConfigLengthNotExceeded = configLengthEEPROM + cfgLen + 1 < MEM_LEN_CONFIG;
-        if (maxConfigLengthNotExceeded) {
-            // save the received config string including the terminatung NULL (+1) to EEPROM
-            MFeeprom.write_block(MEM_OFFSET_CONFIG + configLengthEEPROM, cfg, cfgLen + 1);
-            configLengthEEPROM += cfgLen;
+        if (storeConfigChunk(cfg, cfgLen)) {
             cmdMessenger.sendCmd(kStatus, configLengthEEPROM);
         } else {
             // staus message to connector, failure on setting config
@@ -166,54 +252,38 @@ void OnSetConfig()
     }
 }
 
+// Streaming upload: each chunk has the offset where it belongs to and is acknowledged with the
+// offset of the next expected chunk. So the connector can send several chunks without waiting
+// for the acknowledge of each one, the amount of unacknowledged data must not exceed the
+// serial receive buffer. A chunk with another offset follows a lost chunk or has been received
+// before, it is ignored and the connector continues sending from the acknowledged offset.
+void OnSetConfigChunk()
+{
+    uint16_t offset = (uint16_t)cmdMessenger.readInt16Arg();
+    char    *cfg    = cmdMessenger.readStringArg();
+
+    if (configStoredInFlash() || !cmdMessenger.isArgOk()) {
+        cmdMessenger.sendCmd(kStatus, -1);
+        return;
+    }
+    if (offset == configLengthEEPROM && !storeConfigChunk(cfg, strlen(cfg))) {
+        cmdMessenger.sendCmd(kStatus, -1);
+        return;
+    }
+    configChunksUploaded = true;
+    cmdMessenger.sendCmd(kStatus, configLengthEEPROM);
+}
+
+// The devices of the running config are kept and still updated until the new config
+// gets activated, only the devices which are changed by the new config are cleared then,
+// see readConfig(). Nothing what is used by the devices is touched during the upload.
 void resetConfig()
 {
-    Button::Clear();
-    Encoder::Clear();
-    Output::Clear();
-#if MF_SEGMENT_SUPPORT == 1
-    LedSegment::Clear();
-#endif
-#if MF_SERVO_SUPPORT == 1
-    Servos::Clear();
-#endif
-#if MF_STEPPER_SUPPORT == 1
-#if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-    Stepper::stopUpdate2ndCore(true);
-#endif
-    Stepper::Clear();
-#if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-    Stepper::stopUpdate2ndCore(false);
-#endif
-#endif
-#if MF_LCD_SUPPORT == 1
-    LCDDisplay::Clear();
-#endif
-#if MF_ANALOG_SUPPORT == 1
-    Analog::Clear();
-#endif
-#if MF_OUTPUT_SHIFTER_SUPPORT == 1
-    OutputShifter::Clear();
-#endif
-#if MF_INPUT_SHIFTER_SUPPORT == 1
-    InputShifter::Clear();
-#endif
-#if MF_DIGIN_MUX_SUPPORT == 1
-    DigInMux::Clear();
-#endif
-#if MF_CUSTOMDEVICE_SUPPORT == 1
-#if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-    CustomDevice::stopUpdate2ndCore(true);
-#endif
-    CustomDevice::Clear();
-#if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-    CustomDevice::stopUpdate2ndCore(false);
-#endif
-#endif
     configLengthEEPROM = 0;
-    configActivated    = false;
-    pNameBuffer        = 0;
-    ClearMemory();
+    // a new config is always stored with header
+    configStartEEPROM    = MEM_OFFSET_CONFIG + CONFIG_HEADER_SIZE;
+    configCrcEEPROM      = 0xFFFF;
+    configChunksUploaded = false;
 }
 
 void OnResetConfig()
@@ -224,6 +294,21 @@ void OnResetConfig()
 
 void OnSaveConfig()
 {
+    // length and CRC of the complete config for checking the upload, they are optional
+    // for kSetConfig and required for kSetConfigChunk as a lost chunk is only detected by them
+    uint16_t length  = (uint16_t)cmdMessenger.readInt32Arg();
+    uint16_t crc     = (uint16_t)cmdMessenger.readInt32Arg();
+    bool     checked = cmdMessenger.isArgOk();
+    if ((checked && (length != configLengthEEPROM || crc != configCrcEEPROM)) || (!checked && configChunksUploaded)) {
+        // the stored config stays invalid and the last saved one is kept on the RP2040
+        resetConfig();
+        cmdMessenger.sendCmd(kStatus, -1);
+        return;
+    }
+    // a config without header from an older firmware is kept as it is, a header is
+    // only written for a config which has been uploaded after resetConfig()
+    if (!configStoredInFlash() && configStartEEPROM == MEM_OFFSET_CONFIG + CONFIG_HEADER_SIZE)
+        writeConfigHeader();
     MFeeprom.commit();
     cmdMessenger.sendCmd(kConfigSaved, F("OK"));
 }
@@ -237,6 +322,9 @@ void OnActivateConfig()
 void _activateConfig()
 {
     configActivated = true;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    IOCore::stopUpdate2ndCore(false);
+#endif
     cmdMessenger.sendCmd(kConfigActivated, F("OK"));
 }
 
@@ -303,31 +391,133 @@ bool readEndCommand(uint16_t *addrMem, uint8_t delimiter, bool configFromFlash)
     return true;
 }
 
+#if defined(ARDUINO_ARCH_AVR)
+bool spiPinsFree = false; // SS, MOSI and MISO are not used by other devices of the config
+
+// Checks if a config parameter uses SS, MOSI or MISO. Shift register pins are
+// allowed in their SPI role, latch on SS, output data on MOSI and input data on MISO.
+bool isSpiPinConflict(uint8_t type, uint8_t index, uint16_t value)
+{
+    if (value != SS && value != MOSI && value != MISO)
+        return false;
+    // no pins, but I2C address, columns and lines
+    if (type == kTypeLcdDisplayI2C)
+        return false;
+    if (type == kTypeOutputShifter || type == kTypeInputShifter) {
+        if (index == 1) // latch
+            return value != SS;
+        if (index == 3) // data
+            return value != (type == kTypeOutputShifter ? MOSI : MISO);
+        // index 2 is the clock, index 4 the number of modules
+        return index == 2;
+    }
+    // all other numbers are taken as pins, at worst the shifters are bit-banged
+    return true;
+}
+
+// The hardware SPI takes over SS and MOSI as outputs and MISO as input, and with SS as
+// input pulled low it falls into slave mode and blocks. So the shift registers use it
+// only if no other device of the config uses these pins.
+bool checkSpiPinsFree(bool configFromFlash)
+{
+    uint16_t addrMem = configFromFlash ? 0 : configStartEEPROM;
+    uint16_t length  = configFromFlash ? configLengthFlash : MFeeprom.get_length();
+    uint8_t  type    = kTypeNotSet;
+    uint8_t  index   = 0; // position of the parameter in the device entry, 0 is the type
+    uint16_t value   = 0;
+    bool     number  = true;
+
+    while (addrMem < length) {
+        char c = configFromFlash ? pgm_read_byte_near(CustomDeviceConfig + addrMem++) : MFeeprom.read_byte(addrMem++);
+        if (c == 0x00)
+            break;
+        if (c == '.') {
+            if (index == 0)
+                type = value;
+            else if (number && isSpiPinConflict(type, index, value))
+                return false;
+            index++;
+            value  = 0;
+            number = true;
+        } else if (c == ':') {
+            // the name is the last parameter
+            index  = 0;
+            value  = 0;
+            number = true;
+        } else if (c >= '0' && c <= '9' && value < 1000) {
+            value = value * 10 + c - '0';
+        } else {
+            number = false;
+        }
+    }
+    return true;
+}
+
+bool spiPinsAvailable()
+{
+    return spiPinsFree;
+}
+#endif
+
 void sendFailureMessage(const char *deviceName)
 {
+    // the config gets completely rebuilt if the changed devices do not fit
+    if (GetMemoryTrial())
+        return;
     cmdMessenger.sendCmdStart(kStatus);
     cmdMessenger.sendCmdArg(deviceName);
     cmdMessenger.sendCmdArg(F("does not fit in Memory"));
     cmdMessenger.sendCmdEnd();
 }
 
-bool GetArraySizes(uint8_t *numberDevices, bool configFromFlash)
+// Deprecated device types are handled by the same subsystem as the type which replaces them,
+// the device group is the type of this subsystem
+uint8_t getDeviceGroup(uint8_t type)
+{
+    switch (type) {
+    case kTypeLedSegmentDeprecated:
+        return kTypeLedSegmentMulti;
+    case kTypeStepperDeprecated1:
+    case kTypeStepperDeprecated2:
+        return kTypeStepper;
+    case kTypeEncoderSingleDetent:
+        return kTypeEncoder;
+    }
+    return (type < kTypeMax) ? type : kTypeNotSet;
+}
+
+static uint32_t groupBit(uint8_t type)
+{
+    return 1UL << getDeviceGroup(type);
+}
+
+// counts the devices per type and calculates a CRC over all entries per device group
+bool GetArraySizes(uint8_t *numberDevices, uint16_t *groupCrc, bool configFromFlash)
 {
     bool     copy_success = true;
     uint16_t addrMem;
+    uint16_t addrEntry;
     uint8_t  device;
     if (configFromFlash)
         addrMem = 0;
     else
-        addrMem = MEM_OFFSET_CONFIG;
+        addrMem = configStartEEPROM;
 
     device = readUint(&addrMem, configFromFlash);
 
     // step through the Memory and calculate the number of devices for each type
     do {
+        if (device >= kTypeMax) {
+            copy_success = false;
+            break;
+        }
         numberDevices[device]++;
+        addrEntry    = addrMem;
         copy_success = readEndCommand(&addrMem, ':', configFromFlash); // check EEPROM until end of name
-        device       = readUint(&addrMem, configFromFlash);
+        uint8_t group   = getDeviceGroup(device);
+        groupCrc[group] = crc16(groupCrc[group], &device, 1);
+        groupCrc[group] = crc16Config(groupCrc[group], addrEntry, addrMem - addrEntry, configFromFlash);
+        device          = readUint(&addrMem, configFromFlash);
     } while (device && copy_success);
 
     if (!copy_success) { // too much/long names for input devices -> tbd how to handle this!!
@@ -337,71 +527,291 @@ bool GetArraySizes(uint8_t *numberDevices, bool configFromFlash)
     return true;
 }
 
-void InitArrays(uint8_t *numberDevices)
+// Call the function to allocate required memory for the arrays of each type of the given device groups
+void InitArrays(uint8_t *numberDevices, uint32_t groups)
 {
-    // Call the function to allocate required memory for the arrays of each type
-    if (!Button::setupArray(numberDevices[kTypeButton]))
-        sendFailureMessage("Button");
-    if (!Output::setupArray(numberDevices[kTypeOutput]))
-        sendFailureMessage("Output");
+    if (groups & groupBit(kTypeButton)) {
+        SetMemoryOwner(kTypeButton);
+        if (!Button::setupArray(numberDevices[kTypeButton]))
+            sendFailureMessage("Button");
+    }
+    if (groups & groupBit(kTypeOutput)) {
+        SetMemoryOwner(kTypeOutput);
+        if (!Output::setupArray(numberDevices[kTypeOutput]))
+            sendFailureMessage("Output");
+    }
 #if MF_SEGMENT_SUPPORT == 1
-    if (!LedSegment::setupArray(numberDevices[kTypeLedSegmentDeprecated] + numberDevices[kTypeLedSegmentMulti]))
-        sendFailureMessage("7Segment");
+    if (groups & groupBit(kTypeLedSegmentMulti)) {
+        SetMemoryOwner(kTypeLedSegmentMulti);
+        if (!LedSegment::setupArray(numberDevices[kTypeLedSegmentDeprecated] + numberDevices[kTypeLedSegmentMulti]))
+            sendFailureMessage("7Segment");
+    }
 #endif
 #if MF_STEPPER_SUPPORT == 1
-    if (!Stepper::setupArray(numberDevices[kTypeStepper] + numberDevices[kTypeStepperDeprecated1] + numberDevices[kTypeStepperDeprecated2]))
-        sendFailureMessage("Stepper");
+    if (groups & groupBit(kTypeStepper)) {
+        SetMemoryOwner(kTypeStepper);
+        if (!Stepper::setupArray(numberDevices[kTypeStepper] + numberDevices[kTypeStepperDeprecated1] + numberDevices[kTypeStepperDeprecated2]))
+            sendFailureMessage("Stepper");
+    }
 #endif
 #if MF_SERVO_SUPPORT == 1
-    if (!Servos::setupArray(numberDevices[kTypeServo]))
-        sendFailureMessage("Servo");
+    if (groups & groupBit(kTypeServo)) {
+        SetMemoryOwner(kTypeServo);
+        if (!Servos::setupArray(numberDevices[kTypeServo]))
+            sendFailureMessage("Servo");
+    }
 #endif
-    if (!Encoder::setupArray(numberDevices[kTypeEncoder] + numberDevices[kTypeEncoderSingleDetent]))
-        sendFailureMessage("Encoders");
+    if (groups & groupBit(kTypeEncoder)) {
+        SetMemoryOwner(kTypeEncoder);
+        if (!Encoder::setupArray(numberDevices[kTypeEncoder] + numberDevices[kTypeEncoderSingleDetent]))
+            sendFailureMessage("Encoders");
+    }
 #if MF_LCD_SUPPORT == 1
-    if (!LCDDisplay::setupArray(numberDevices[kTypeLcdDisplayI2C]))
-        sendFailureMessage("LCD");
+    if (groups & groupBit(kTypeLcdDisplayI2C)) {
+        SetMemoryOwner(kTypeLcdDisplayI2C);
+        if (!LCDDisplay::setupArray(numberDevices[kTypeLcdDisplayI2C]))
+            sendFailureMessage("LCD");
+    }
 #endif
 #if MF_ANALOG_SUPPORT == 1
-    if (!Analog::setupArray(numberDevices[kTypeAnalogInput]))
-        sendFailureMessage("AnalogIn");
+    if (groups & groupBit(kTypeAnalogInput)) {
+        SetMemoryOwner(kTypeAnalogInput);
+        if (!Analog::setupArray(numberDevices[kTypeAnalogInput]))
+            sendFailureMessage("AnalogIn");
+    }
+    if (groups & groupBit(kTypeAnalogMux)) {
+        SetMemoryOwner(kTypeAnalogMux);
+        if (!AnalogMux::setupArray(numberDevices[kTypeAnalogMux]))
+            sendFailureMessage("AnalogMux");
+    }
 #endif
 #if MF_OUTPUT_SHIFTER_SUPPORT == 1
-    if (!OutputShifter::setupArray(numberDevices[kTypeOutputShifter]))
-        sendFailureMessage("OutputShifter");
+    if (groups & groupBit(kTypeOutputShifter)) {
+        SetMemoryOwner(kTypeOutputShifter);
+        if (!OutputShifter::setupArray(numberDevices[kTypeOutputShifter]))
+            sendFailureMessage("OutputShifter");
+    }
 #endif
 #if MF_INPUT_SHIFTER_SUPPORT == 1
-    if (!InputShifter::setupArray(numberDevices[kTypeInputShifter]))
-        sendFailureMessage("InputShifter");
+    if (groups & groupBit(kTypeInputShifter)) {
+        SetMemoryOwner(kTypeInputShifter);
+        if (!InputShifter::setupArray(numberDevices[kTypeInputShifter]))
+            sendFailureMessage("InputShifter");
+    }
 #endif
 #if MF_DIGIN_MUX_SUPPORT == 1
-    if (!DigInMux::setupArray(numberDevices[kTypeDigInMux]))
-        sendFailureMessage("DigInMux");
+    if (groups & groupBit(kTypeDigInMux)) {
+        SetMemoryOwner(kTypeDigInMux);
+        if (!DigInMux::setupArray(numberDevices[kTypeDigInMux]))
+            sendFailureMessage("DigInMux");
+    }
+    if (groups & groupBit(kTypeDigInMuxCascade)) {
+        SetMemoryOwner(kTypeDigInMuxCascade);
+        if (!DigInMuxCascade::setupArray(numberDevices[kTypeDigInMuxCascade]))
+            sendFailureMessage("DigInMuxCascade");
+    }
+#endif
+#if MF_KEYMATRIX_SUPPORT == 1
+    if (groups & groupBit(kTypeKeyMatrix)) {
+        SetMemoryOwner(kTypeKeyMatrix);
+        if (!KeyMatrix::setupArray(numberDevices[kTypeKeyMatrix]))
+            sendFailureMessage("KeyMatrix");
+    }
 #endif
 #if MF_CUSTOMDEVICE_SUPPORT == 1
-    if (!CustomDevice::setupArray(numberDevices[kTypeCustomDevice]))
-        sendFailureMessage("CustomDevice");
+    if (groups & groupBit(kTypeCustomDevice)) {
+        SetMemoryOwner(kTypeCustomDevice);
+        if (!CustomDevice::setupArray(numberDevices[kTypeCustomDevice]))
+            sendFailureMessage("CustomDevice");
+    }
 #endif
     return;
 }
 
+// clears the devices of the given device groups and releases their memory and names
+void clearDevices(uint32_t groups)
+{
+    if (groups & groupBit(kTypeButton))
+        Button::Clear();
+    if (groups & groupBit(kTypeEncoder))
+        Encoder::Clear();
+    if (groups & groupBit(kTypeOutput))
+        Output::Clear();
+#if MF_SEGMENT_SUPPORT == 1
+    if (groups & groupBit(kTypeLedSegmentMulti))
+        LedSegment::Clear();
+#endif
+#if MF_SERVO_SUPPORT == 1
+    if (groups & groupBit(kTypeServo))
+        Servos::Clear();
+#endif
+#if MF_STEPPER_SUPPORT == 1
+    if (groups & groupBit(kTypeStepper)) {
+#if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        Stepper::stopUpdate2ndCore(true);
+#endif
+        Stepper::Clear();
+#if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        Stepper::stopUpdate2ndCore(false);
+#endif
+    }
+#endif
+#if MF_LCD_SUPPORT == 1
+    if (groups & groupBit(kTypeLcdDisplayI2C))
+        LCDDisplay::Clear();
+#endif
+#if MF_ANALOG_SUPPORT == 1
+    if (groups & groupBit(kTypeAnalogInput))
+        Analog::Clear();
+    if (groups & groupBit(kTypeAnalogMux))
+        AnalogMux::Clear();
+#endif
+#if MF_OUTPUT_SHIFTER_SUPPORT == 1
+    if (groups & groupBit(kTypeOutputShifter))
+        OutputShifter::Clear();
+#endif
+#if MF_INPUT_SHIFTER_SUPPORT == 1
+    if (groups & groupBit(kTypeInputShifter))
+        InputShifter::Clear();
+#endif
+#if MF_DIGIN_MUX_SUPPORT == 1
+    if (groups & groupBit(kTypeDigInMux))
+        DigInMux::Clear();
+    if (groups & groupBit(kTypeDigInMuxCascade))
+        DigInMuxCascade::Clear();
+#endif
+#if MF_KEYMATRIX_SUPPORT == 1
+    if (groups & groupBit(kTypeKeyMatrix))
+        KeyMatrix::Clear();
+#endif
+#if MF_CUSTOMDEVICE_SUPPORT == 1
+    if (groups & groupBit(kTypeCustomDevice)) {
+#if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        CustomDevice::stopUpdate2ndCore(true);
+#endif
+        CustomDevice::Clear();
+#if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        CustomDevice::stopUpdate2ndCore(false);
+#endif
+    }
+#endif
+    for (uint8_t group = 0; group < kTypeMax; group++) {
+        if (!(groups & (1UL << group)))
+            continue;
+        ReleaseMemory(group);
+        nameEnd[group] = 0;
+    }
+    // names of the kept devices must not be overwritten
+    pNameBuffer = 0;
+    for (uint8_t group = 0; group < kTypeMax; group++) {
+        if (nameEnd[group] > pNameBuffer)
+            pNameBuffer = nameEnd[group];
+    }
+}
+
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+// tasks of the 2nd core which are using the devices of the given groups
+uint16_t getIOTasks(uint32_t groups)
+{
+    uint16_t tasks = 0;
+    if (groups & groupBit(kTypeButton))
+        tasks |= 1 << kTaskButtons;
+    if (groups & groupBit(kTypeEncoder))
+        tasks |= 1 << kTaskEncoders;
+    if (groups & groupBit(kTypeInputShifter))
+        tasks |= 1 << kTaskInputShifters;
+    if (groups & groupBit(kTypeDigInMux))
+        tasks |= 1 << kTaskDigInMux;
+    if (groups & groupBit(kTypeDigInMuxCascade))
+        tasks |= 1 << kTaskDigInMuxCascade;
+    if (groups & groupBit(kTypeKeyMatrix))
+        tasks |= 1 << kTaskKeyMatrix;
+    if (groups & groupBit(kTypeLcdDisplayI2C))
+        tasks |= 1 << kTaskLcdDisplays;
+    if (groups & groupBit(kTypeLedSegmentMulti))
+        tasks |= 1 << kTaskSegments;
+    if (groups & groupBit(kTypeAnalogInput))
+        tasks |= (1 << kTaskAnalogAverage) | (1 << kTaskAnalog);
+    if (groups & groupBit(kTypeAnalogMux))
+        tasks |= 1 << kTaskAnalogMux;
+    return tasks;
+}
+#endif
+
+// Only the devices of groups whose entries have changed are cleared and read in again,
+// all other devices keep their memory and state. If the changed devices do not fit into
+// the remaining memory, all devices are cleared and the complete config is read in again.
 void readConfig()
 {
-    uint8_t numberDevices[kTypeMax] = {0};
+    uint8_t  numberDevices[kTypeMax] = {0};
+    uint16_t groupCrc[kTypeMax];
+    uint32_t changed         = 0;
+    bool     configFromFlash = configStoredInFlash();
 
-    // Early return if no valid configuration is found
-    if (!configStoredInFlash() && !configStoredInEEPROM()) {
-        InitArrays(numberDevices);
-        return;
+#if MF_INPUT_SHIFTER_SUPPORT == 1
+    // the connector enables the compact events again for the new config
+    InputShifter::ResetCompactEvents();
+#endif
+
+    for (uint8_t group = 0; group < kTypeMax; group++)
+        groupCrc[group] = 0xFFFF;
+    // no devices get added if no valid configuration is found
+    bool configValid = (configFromFlash || configStoredInEEPROM()) && GetArraySizes(numberDevices, groupCrc, configFromFlash);
+    if (!configValid) {
+        for (uint8_t i = 0; i < kTypeMax; i++) {
+            numberDevices[i] = 0;
+            groupCrc[i]      = 0xFFFF;
+        }
+    }
+    for (uint8_t group = 0; group < kTypeMax; group++) {
+        if (!devicesBuilt || groupCrc[group] != deviceCrc[group])
+            changed |= 1UL << group;
     }
+#if defined(ARDUINO_ARCH_AVR)
+    // the shifters have to check again if they can use the hardware SPI
+    bool spiFree = configValid && checkSpiPinsFree(configFromFlash);
+    if (spiFree != spiPinsFree)
+        changed |= groupBit(kTypeOutputShifter) | groupBit(kTypeInputShifter);
+    spiPinsFree = spiFree;
+#endif
+#if defined(ARDUINO_ARCH_RP2040) && MF_SERVO_SUPPORT == 1
+    // servos only use the PWM slices without outputs, so they have to check them again
+    if (changed & groupBit(kTypeOutput))
+        changed |= groupBit(kTypeServo);
+#endif
 
-    // Determine which configuration to use and proceed
-    GetArraySizes(numberDevices, configStoredInFlash());
-    InitArrays(numberDevices);
-    readConfigFromMemory(configStoredInFlash());
+    if (devicesBuilt) {
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        // inputs of the unchanged devices are still scanned by the 2nd core
+        IOCore::pauseTasks(getIOTasks(changed));
+#endif
+        SetMemoryTrial(true);
+        clearDevices(changed);
+        InitArrays(numberDevices, changed);
+        bool success = (!configValid || readConfigFromMemory(configFromFlash, changed)) && !MemoryOverflow();
+        SetMemoryTrial(false);
+        if (success) {
+            memcpy(deviceCrc, groupCrc, sizeof(deviceCrc));
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+            IOCore::pauseTasks(0);
+#endif
+            return;
+        }
+    }
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    IOCore::stopUpdate2ndCore(true);
+    IOCore::pauseTasks(0);
+#endif
+    clearDevices(0xFFFFFFFF);
+    ClearMemory();
+    InitArrays(numberDevices, 0xFFFFFFFF);
+    if (configValid)
+        readConfigFromMemory(configFromFlash, 0xFFFFFFFF);
+    memcpy(deviceCrc, groupCrc, sizeof(deviceCrc));
+    devicesBuilt = true;
 }
 
-void readConfigFromMemory(bool configFromFlash)
+bool readConfigFromMemory(bool configFromFlash, uint32_t groups)
 {
     uint16_t addrMem      = 0;    // define first memory location where config is saved in EEPROM or Flash
     char     params[8]    = "";   // buffer for reading parameters from EEPROM or Flash and sending to ::Add() function of device
@@ -410,7 +820,7 @@ void readConfigFromMemory(bool configFromFlash)
                                   // not required anymore when pins instead of names are transferred to the UI
 
     if (!configFromFlash) {
-        addrMem = MEM_OFFSET_CONFIG;
+        addrMem = configStartEEPROM;
     }
 
     // read the first value from EEPROM, it's a device definition
@@ -418,6 +828,12 @@ void readConfigFromMemory(bool configFromFlash)
 
     // go through the EEPROM or Flash until it is NULL terminated
     do {
+        uint8_t  group   = getDeviceGroup(command);
+        uint16_t namePos = pNameBuffer;
+        // devices which are kept from the last config are just skipped
+        if (!(groups & (1UL << group)))
+            command = kTypeNotSet;
+        SetMemoryOwner(group);
         switch (command) {
         case kTypeButton:
             params[0] = readUint(&addrMem, configFromFlash);                              // Pin number
@@ -521,6 +937,18 @@ void readConfigFromMemory(bool configFromFlash)
             copy_success = readName(&addrMem, nameBuffer, &pNameBuffer, configFromFlash); // copy the NULL terminated name to to nameBuffer and set to next free memory location
                                                                                           //    copy_success = readEndCommand(&addrMem, ':');       // once the nameBuffer is not required anymore uncomment this line and delete the line before
             break;
+
+        case kTypeAnalogMux:
+            params[0] = readUint(&addrMem, configFromFlash); // pin number
+            params[1] = readUint(&addrMem, configFromFlash); // Sel0 pin
+            params[2] = readUint(&addrMem, configFromFlash); // Sel1 pin
+            params[3] = readUint(&addrMem, configFromFlash); // Sel2 pin
+            params[4] = readUint(&addrMem, configFromFlash); // Sel3 pin
+            params[5] = readUint(&addrMem, configFromFlash); // number of channels (1-16)
+            params[6] = readUint(&addrMem, configFromFlash); // sensitivity
+            AnalogMux::Add(params[0], params[1], params[2], params[3], params[4], params[5], &nameBuffer[pNameBuffer], params[6]);
+            copy_success = readName(&addrMem, nameBuffer, &pNameBuffer, configFromFlash);
+            break;
 #endif
 
 #if MF_OUTPUT_SHIFTER_SUPPORT == 1
@@ -550,17 +978,43 @@ void readConfigFromMemory(bool configFromFlash)
         case kTypeDigInMux:
             params[0] = readUint(&addrMem, configFromFlash); // data pin
             // Mux driver section
-            // Repeated commands do not define more objects, but change the only existing one
-            // therefore beware that all DigInMux configuration commands are consistent!
+            // DigInMux with the same select pins share one mux driver
             params[1] = readUint(&addrMem, configFromFlash); // Sel0 pin
             params[2] = readUint(&addrMem, configFromFlash); // Sel1 pin
             params[3] = readUint(&addrMem, configFromFlash); // Sel2 pin
             params[4] = readUint(&addrMem, configFromFlash); // Sel3 pin
-            MUX.attach(params[1], params[2], params[3], params[4]);
             params[5] = readUint(&addrMem, configFromFlash); // 8-bit registers (1-2)
-            DigInMux::Add(params[0], params[5], &nameBuffer[pNameBuffer]);
+            DigInMux::Add(params[0], params[1], params[2], params[3], params[4], params[5], &nameBuffer[pNameBuffer]);
+            copy_success = readName(&addrMem, nameBuffer, &pNameBuffer, configFromFlash);
+            break;
+
+        case kTypeDigInMuxCascade: {
+            uint8_t selPins[8];
+            params[0] = readUint(&addrMem, configFromFlash); // data pin
+            for (uint8_t i = 0; i < 8; i++)
+                selPins[i] = readUint(&addrMem, configFromFlash); // Sel0-3 pins of the 2nd level, Sel4-7 pins of the 1st level
+            params[1] = readUint(&addrMem, configFromFlash);       // number of 2nd level muxes (1-16)
+            DigInMuxCascade::Add(params[0], selPins, params[1], &nameBuffer[pNameBuffer]);
+            copy_success = readName(&addrMem, nameBuffer, &pNameBuffer, configFromFlash);
+            break;
+        }
+#endif
+
+#if MF_KEYMATRIX_SUPPORT == 1
+        case kTypeKeyMatrix: {
+            uint8_t pins[16]; // up to 8 row and 8 column pins
+            params[0] = readUint(&addrMem, configFromFlash); // number of rows
+            params[1] = readUint(&addrMem, configFromFlash); // number of columns
+            // row pins followed by the column pins
+            for (uint8_t i = 0; i < params[0] + params[1]; i++) {
+                uint8_t pin = readUint(&addrMem, configFromFlash);
+                if (i < sizeof(pins))
+                    pins[i] = pin;
+            }
+            KeyMatrix::Add(params[0], params[1], pins, &nameBuffer[pNameBuffer]);
             copy_success = readName(&addrMem, nameBuffer, &pNameBuffer, configFromFlash);
             break;
+        }
 #endif
 
 #if MF_CUSTOMDEVICE_SUPPORT == 1
@@ -588,26 +1042,39 @@ void readConfigFromMemory(bool configFromFlash)
         default:
             copy_success = readEndCommand(&addrMem, ':', configFromFlash); // check EEPROM until end of name
         }
+        if (pNameBuffer != namePos)
+            nameEnd[group] = pNameBuffer;
         command = readUint(&addrMem, configFromFlash);
     } while (command && copy_success);
     if (!copy_success) {                            // too much/long names for input devices
         nameBuffer[MEMLEN_NAMES_BUFFER - 1] = 0x00; // terminate the last copied (part of) string with 0x00
-        cmdMessenger.sendCmd(kStatus, F("Failure on reading config"));
+        if (!GetMemoryTrial())
+            cmdMessenger.sendCmd(kStatus, F("Failure on reading config"));
     }
+    return copy_success;
 }
 
+// The config is read blockwise into a small buffer which is written at once to the serial port.
+// The first character is sent with sendCmdArg() to get the separator in front of it.
 void OnGetConfig()
 {
+    uint8_t  buffer[32];
+    uint16_t chunk;
+
     cmdMessenger.sendCmdStart(kInfo);
     if (configStoredInEEPROM()) {
-        cmdMessenger.sendCmdArg((char)MFeeprom.read_byte(MEM_OFFSET_CONFIG));
-        for (uint16_t i = 1; i < configLengthEEPROM; i++) {
-            cmdMessenger.sendArg((char)MFeeprom.read_byte(MEM_OFFSET_CONFIG + i));
+        cmdMessenger.sendCmdArg((char)MFeeprom.read_byte(configStartEEPROM));
+        for (uint16_t i = 1; i < configLengthEEPROM; i += chunk) {
+            chunk = min((uint16_t)sizeof(buffer), (uint16_t)(configLengthEEPROM - i));
+            MFeeprom.read_block(configStartEEPROM + i, buffer, chunk);
+            Serial.write(buffer, chunk);
         }
     } else if (configStoredInFlash()) {
         cmdMessenger.sendCmdArg((char)pgm_read_byte_near(CustomDeviceConfig));
-        for (uint16_t i = 1; i < (configLengthFlash - 1); i++) {
-            cmdMessenger.sendArg((char)pgm_read_byte_near(CustomDeviceConfig + i));
+        for (uint16_t i = 1; i < (configLengthFlash - 1); i += chunk) {
+            chunk = min((uint16_t)sizeof(buffer), (uint16_t)(configLengthFlash - 1 - i));
+            memcpy_P(buffer, CustomDeviceConfig + i, chunk);
+            Serial.write(buffer, chunk);
         }
     }
     cmdMessenger.sendCmdEnd();
@@ -621,6 +1088,10 @@ void OnGetInfo()
     // OnGetInfo() is called from the connector and the time is very likely always different
     // Therefore millis() can be used for randomSeed
     generateSerial(false);
+#if MF_INPUT_SHIFTER_SUPPORT == 1
+    // a (re)connected connector gets the single input shifter events until it enables the compact ones
+    InputShifter::ResetCompactEvents();
+#endif
     cmdMessenger.sendCmdStart(kInfo);
     cmdMessenger.sendCmdArg(F(MOBIFLIGHT_TYPE));
     cmdMessenger.sendCmdArg(name);
@@ -738,7 +1209,8 @@ void storeName()
     if (!configStoredInFlash()) {
         MFeeprom.write_byte(MEM_OFFSET_NAME, '#');
         MFeeprom.write_block(MEM_OFFSET_NAME + 1, name, MEM_LEN_NAME - 1);
-        // MFeeprom.commit() is not required, name is always set before config
+        // MFeeprom.commit() is not required, name is always set before config.
+        // It must not be committed here, the RAM copy of the RP2040 may contain a partially uploaded config
     }
 }
 
@@ -0,0 +1,195 @@
+//
+// IOCore.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "mobiflight.h"
+#include "IOCore.h"
+
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+#include "MFSpscQueue.h"
+
+#ifndef MF_IOCORE_EVENT_QUEUE
+#define MF_IOCORE_EVENT_QUEUE 64
+#endif
+#ifndef MF_IOCORE_CALL_QUEUE
+#define MF_IOCORE_CALL_QUEUE 32
+#endif
+
+namespace IOCore
+{
+    typedef struct {
+        const char *name;
+        int16_t     value;
+        uint8_t     type;
+        uint8_t     command;
+        uint8_t     pin;
+    } ioEvent;
+
+    typedef struct {
+        ioFunction fun;
+        uint16_t   tasks;
+        uint8_t    args[4];
+    } ioCall;
+
+    MFScheduler                                  scheduler;
+    MFSpscQueue<ioEvent, MF_IOCORE_EVENT_QUEUE> events; // 2nd core -> 1st core
+    MFSpscQueue<ioCall, MF_IOCORE_CALL_QUEUE>   calls;  // 1st core -> 2nd core
+    volatile bool                                stopRequested  = true; // only written by the 1st core
+    volatile bool                                stopped        = true; // only written by the 2nd core
+    volatile uint16_t                            pauseRequested = 0;    // only written by the 1st core
+    volatile uint16_t                            pausedTasks    = 0;    // only written by the 2nd core
+
+    // arguments and result of setTiming(), the 1st core waits for the result
+    struct {
+        uint16_t period;
+        uint16_t phase;
+        uint8_t  id;
+        uint8_t  priority;
+        bool     success;
+        bool     done;
+    } timing;
+
+    void pushEvent(uint8_t type, uint8_t command, const char *name, uint8_t pin, int16_t value)
+    {
+        ioEvent event = {name, value, type, command, pin};
+        // the queue is only full if the serial output can't keep up,
+        // wait instead of losing an event
+        while (!events.push(event))
+            ;
+    }
+
+    void sendEvents()
+    {
+        ioEvent event;
+        bool    compactStarted = false;
+        while (1) {
+            if (!events.pop(&event)) {
+                // A started compact message is completed before returning, otherwise other
+                // commands of the 1st core would be sent within it. The 2nd core pushes
+                // the end right after the changes of the input shifter.
+                if (!compactStarted)
+                    return;
+                continue;
+            }
+            switch (event.type) {
+            case EVENT_VALUE:
+                cmdMessenger.sendCmdStart(event.command);
+                cmdMessenger.sendCmdArg(event.name);
+                cmdMessenger.sendCmdArg(event.value);
+                cmdMessenger.sendCmdEnd();
+                break;
+            case EVENT_PIN_VALUE:
+                cmdMessenger.sendCmdStart(event.command);
+                cmdMessenger.sendCmdArg(event.name);
+                cmdMessenger.sendCmdArg(event.pin);
+                cmdMessenger.sendCmdArg(event.value);
+                cmdMessenger.sendCmdEnd();
+                break;
+            case EVENT_COMPACT_START:
+                cmdMessenger.sendCmdStart(event.command);
+                cmdMessenger.sendCmdArg(event.name);
+                compactStarted = true;
+                break;
+            case EVENT_COMPACT_ARG:
+                cmdMessenger.sendCmdArg(event.pin);
+                cmdMessenger.sendCmdArg(event.value);
+                break;
+            case EVENT_COMPACT_END:
+                cmdMessenger.sendCmdEnd();
+                compactStarted = false;
+                break;
+            }
+        }
+    }
+
+    void call(uint16_t tasks, ioFunction fun, uint8_t arg0, uint8_t arg1, uint8_t arg2, uint8_t arg3)
+    {
+        ioCall request = {fun, tasks, {arg0, arg1, arg2, arg3}};
+        // the 2nd core might wait for free space in the event queue
+        while (!calls.push(request))
+            sendEvents();
+    }
+
+    // Stops scanning the inputs while a config gets loaded, pending calls accessing
+    // devices are dropped. Only here and in pauseTasks() the 1st core waits for the 2nd core.
+    void stopUpdate2ndCore(bool stop)
+    {
+        // release: the calls queued before are seen by the 2nd core together with the request
+        __atomic_store_n(&stopRequested, stop, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&stopped, __ATOMIC_ACQUIRE) != stop)
+            sendEvents();
+        // events of the old config are referring to names which gets cleared
+        sendEvents();
+    }
+
+    // Pauses only the tasks using devices which get cleared, all other inputs
+    // are still scanned while a config gets loaded.
+    void pauseTasks(uint16_t tasks)
+    {
+        __atomic_store_n(&pauseRequested, tasks, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&pausedTasks, __ATOMIC_ACQUIRE) != tasks)
+            sendEvents();
+        sendEvents();
+    }
+
+    // executed on the 2nd core, the arguments are passed in timing
+    void setTiming2ndCore(uint8_t, uint8_t, uint8_t, uint8_t)
+    {
+        timing.success = scheduler.setTiming(timing.id, timing.period, timing.phase, timing.priority);
+        __atomic_store_n(&timing.done, true, __ATOMIC_RELEASE);
+    }
+
+    // Changes the timing of a task of the 2nd core, waits for the result
+    bool setTiming(uint8_t id, uint16_t period, uint16_t phase, uint8_t priority)
+    {
+        timing.id       = id;
+        timing.period   = period;
+        timing.phase    = phase;
+        timing.priority = priority;
+        timing.done     = false;
+        // the queue makes the arguments visible to the 2nd core
+        call(0, setTiming2ndCore);
+        while (!__atomic_load_n(&timing.done, __ATOMIC_ACQUIRE))
+            sendEvents();
+        return timing.success;
+    }
+} // namespace
+
+void setup1()
+{
+}
+
+void loop1()
+{
+    IOCore::ioCall call;
+
+    while (1) {
+        // The requests are read before the calls are executed and acknowledged after it,
+        // so no call queued before a request can access the devices after the 1st core
+        // got the acknowledge and starts to clear them.
+        bool     stop    = __atomic_load_n(&IOCore::stopRequested, __ATOMIC_ACQUIRE);
+        uint16_t pause   = __atomic_load_n(&IOCore::pauseRequested, __ATOMIC_ACQUIRE);
+        uint16_t blocked = stop ? 0xFFFF : pause;
+        while (IOCore::calls.pop(&call)) {
+            if (!(call.tasks & blocked))
+                call.fun(call.args[0], call.args[1], call.args[2], call.args[3]);
+        }
+        if (stop != IOCore::stopped) {
+            // deadlines have not been kept while stopped
+            if (!stop)
+                IOCore::scheduler.restart();
+            __atomic_store_n(&IOCore::stopped, stop, __ATOMIC_RELEASE);
+        }
+        if (pause != IOCore::pausedTasks) {
+            IOCore::scheduler.setPaused(pause);
+            __atomic_store_n(&IOCore::pausedTasks, pause, __ATOMIC_RELEASE);
+        }
+        if (!stop && getStatusConfig())
+            IOCore::scheduler.run();
+    }
+}
+#endif
+
+// IOCore.cpp
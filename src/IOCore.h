@@ -0,0 +1,53 @@
+//
+// IOCore.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <Arduino.h>
+
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+#if defined(STEPPER_ON_2ND_CORE) || defined(USE_2ND_CORE)
+#error "IO_ON_2ND_CORE can not be combined with STEPPER_ON_2ND_CORE or USE_2ND_CORE"
+#endif
+
+#include "MFScheduler.h"
+
+// function to be executed on the 2nd core, unused arguments are 0
+typedef void (*ioFunction)(uint8_t, uint8_t, uint8_t, uint8_t);
+
+/* **********************************************************************************
+    With IO_ON_2ND_CORE the 2nd core scans all inputs and transmits the display
+    content, the 1st core parses the serial commands and handles all other devices.
+    Input events are passed to the 1st core for sending, hardware accesses for the
+    displays are passed to the 2nd core. Both directions are using lock-free queues,
+    so no core waits for the other one.
+********************************************************************************** */
+namespace IOCore
+{
+    enum {
+        EVENT_VALUE,         // command, name, value
+        EVENT_PIN_VALUE,     // command, name, pin, value
+        EVENT_COMPACT_START, // command, name, pin/value pairs are following
+        EVENT_COMPACT_ARG,   // pin, value
+        EVENT_COMPACT_END
+    };
+
+    extern MFScheduler scheduler;
+
+    // called from the 2nd core
+    void pushEvent(uint8_t type, uint8_t command, const char *name, uint8_t pin, int16_t value);
+    // called from the 1st core
+    void sendEvents();
+    // tasks are the bits of the tasks whose devices are accessed by fun, the call is
+    // dropped if one of them is paused or the 2nd core is stopped
+    void call(uint16_t tasks, ioFunction fun, uint8_t arg0 = 0, uint8_t arg1 = 0, uint8_t arg2 = 0, uint8_t arg3 = 0);
+    void stopUpdate2ndCore(bool stop);
+    void pauseTasks(uint16_t tasks);
+    bool setTiming(uint8_t id, uint16_t period, uint16_t phase, uint8_t priority);
+}
+#endif
+
+// IOCore.h
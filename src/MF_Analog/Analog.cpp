@@ -7,6 +7,7 @@
 #include "mobiflight.h"
 #include "MFAnalog.h"
 #include "Analog.h"
+#include "IOCore.h"
 
 #if MF_ANALOG_SUPPORT == 1
 namespace Analog
@@ -19,10 +20,14 @@ namespace Analog
     {
         if (!getBoardReady())
             return;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_VALUE, kAnalogChange, name, 0, value);
+#else
         cmdMessenger.sendCmdStart(kAnalogChange);
         cmdMessenger.sendCmdArg(name);
         cmdMessenger.sendCmdArg(value);
         cmdMessenger.sendCmdEnd();
+#endif
     };
 
     bool setupArray(uint16_t count)
@@ -51,6 +56,7 @@ namespace Analog
     void Clear(void)
     {
         analogRegistered = 0;
+        maxAnalogIn      = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared analog devices"));
 #endif
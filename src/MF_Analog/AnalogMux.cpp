@@ -0,0 +1,96 @@
+//
+// AnalogMux.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "mobiflight.h"
+#include "MFAnalogMux.h"
+#include "AnalogMux.h"
+#include "IOCore.h"
+
+#if MF_ANALOG_SUPPORT == 1
+namespace AnalogMux
+{
+    MFAnalogMux *analogMux;
+    uint8_t      analogMuxRegistered = 0;
+    uint8_t      maxAnalogMux        = 0;
+
+    void handlerOnAnalogMuxChange(uint8_t channel, int value, const char *name)
+    {
+        if (!getBoardReady())
+            return;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_PIN_VALUE, kAnalogMuxChange, name, channel, value);
+#else
+        cmdMessenger.sendCmdStart(kAnalogMuxChange);
+        cmdMessenger.sendCmdArg(name);
+        cmdMessenger.sendCmdArg(channel);
+        cmdMessenger.sendCmdArg(value);
+        cmdMessenger.sendCmdEnd();
+#endif
+    };
+
+    bool setupArray(uint16_t count)
+    {
+        if (!FitInMemory(sizeof(MFAnalogMux) * count))
+            return false;
+        analogMux    = new (allocateMemory(sizeof(MFAnalogMux) * count)) MFAnalogMux;
+        maxAnalogMux = count;
+        return true;
+    }
+
+    void Add(uint8_t pin, uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin, uint8_t channels, char const *name, uint8_t sensitivity)
+    {
+        if (analogMuxRegistered == maxAnalogMux)
+            return;
+        // the select lines are driven by an own mux driver, they can't be shared with other muxes
+        if (MFMuxDriver::selPinsUsed(Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin)) {
+            cmdMessenger.sendCmd(kStatus, F("AnalogMux select pins are used by another mux"));
+            return;
+        }
+
+        analogMux[analogMuxRegistered] = MFAnalogMux();
+        if (!analogMux[analogMuxRegistered].attach(pin, Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin, channels, sensitivity, name)) {
+            if (!GetMemoryTrial())
+                cmdMessenger.sendCmd(kStatus, F("AnalogMux does not fit in Memory"));
+            return;
+        }
+        MFAnalogMux::attachHandler(handlerOnAnalogMuxChange);
+        analogMuxRegistered++;
+#ifdef DEBUG2CMDMESSENGER
+        cmdMessenger.sendCmd(kDebug, F("Added analog mux device "));
+#endif
+    }
+
+    void Clear(void)
+    {
+        for (uint8_t i = 0; i < analogMuxRegistered; i++) {
+            analogMux[i].detach();
+        }
+        analogMuxRegistered = 0;
+        maxAnalogMux        = 0;
+#ifdef DEBUG2CMDMESSENGER
+        cmdMessenger.sendCmd(kDebug, F("Cleared analog mux devices"));
+#endif
+    }
+
+    // reads one channel of each analog mux per call
+    void read(void)
+    {
+        for (uint8_t i = 0; i < analogMuxRegistered; i++) {
+            analogMux[i].update();
+        }
+    }
+
+    void OnTrigger()
+    {
+        for (uint8_t i = 0; i < analogMuxRegistered; i++) {
+            analogMux[i].retrigger();
+        }
+    }
+
+} // namespace AnalogMux
+#endif
+
+// AnalogMux.cpp
@@ -0,0 +1,19 @@
+//
+// AnalogMux.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <stdint.h>
+namespace AnalogMux
+{
+    bool setupArray(uint16_t count);
+    void Add(uint8_t pin, uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin, uint8_t channels, char const *name = "AnalogMux", uint8_t sensitivity = 3);
+    void Clear();
+    void read();
+    void OnTrigger();
+}
+
+// AnalogMux.h
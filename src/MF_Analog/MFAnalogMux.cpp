@@ -0,0 +1,111 @@
+//
+// MFAnalogMux.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "mobiflight.h"
+#include "MFAnalogMux.h"
+
+// Settling time of the mux output and the sample capacitor of the ADC, only used on startup
+#define ADC_MUX_SETTLE_US 10
+
+analogMuxEvent MFAnalogMux::_handler = NULL;
+
+MFAnalogMux::MFAnalogMux()
+{
+    _initialized = false;
+}
+
+bool MFAnalogMux::attach(uint8_t pin, uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin, uint8_t channels, uint8_t sensitivity, const char *name)
+{
+    if (channels == 0 || channels > 16)
+        return false;
+    if (!FitInMemory(sizeof(channelState) * channels))
+        return false;
+
+    _state       = (channelState *)allocateMemory(sizeof(channelState) * channels);
+    _pin         = pin;
+    _channels    = channels;
+    _sensitivity = sensitivity;
+    _name        = name;
+#if defined(ARDUINO_AVR_PROMICRO16)
+    // ProMicro has a special pin assignment for analog pins, see MFAnalog::attach()
+    if (_pin == 4)
+        _pin = A6;
+    else if (_pin == 6)
+        _pin = A7;
+#endif
+    pinMode(_pin, INPUT_PULLUP);
+    _mux.attach(Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin);
+
+    // set initial values, the filter starts with the first reading
+    for (uint8_t ch = 0; ch < _channels; ch++) {
+        _mux.setChannel(ch);
+        delayMicroseconds(ADC_MUX_SETTLE_US);
+        uint16_t value       = analogRead(_pin);
+        _state[ch].filtered  = value << 4;
+        _state[ch].lastValue = value;
+    }
+    _channel = 0;
+    _mux.setChannel(_channel);
+    _initialized = true;
+    return true;
+}
+
+void MFAnalogMux::detach()
+{
+    if (!_initialized)
+        return;
+    _mux.detach();
+    _initialized = false;
+}
+
+// Reads the selected channel and selects the next one, the changed value
+// of the channel is sent if it differs by at least the sensitivity
+void MFAnalogMux::update()
+{
+    if (!_initialized)
+        return;
+
+    channelState *state  = &_state[_channel];
+    int16_t       sample = analogRead(_pin) << 4;
+    uint8_t       ch     = _channel;
+
+    // select the next channel as early as possible to give it the most time to settle
+    if (++_channel >= _channels)
+        _channel = 0;
+    _mux.setChannel(_channel);
+
+    // exponential moving average, needs only one word per channel instead of a sample buffer
+    state->filtered += (sample - (int16_t)state->filtered) >> ADC_MUX_FILTER_LOG2;
+    uint16_t value = (state->filtered + 8) >> 4;
+    if (abs((int16_t)value - (int16_t)state->lastValue) >= _sensitivity) {
+        state->lastValue = value;
+        trigger(ch, value);
+    }
+}
+
+void MFAnalogMux::retrigger()
+{
+    if (!_initialized)
+        return;
+    for (uint8_t ch = 0; ch < _channels; ch++) {
+        _state[ch].lastValue = (_state[ch].filtered + 8) >> 4;
+        trigger(ch, _state[ch].lastValue);
+    }
+}
+
+void MFAnalogMux::trigger(uint8_t channel, uint16_t value)
+{
+    if (_handler != NULL) {
+        (*_handler)(channel, value, _name);
+    }
+}
+
+void MFAnalogMux::attachHandler(analogMuxEvent newHandler)
+{
+    _handler = newHandler;
+}
+
+// MFAnalogMux.cpp
@@ -0,0 +1,61 @@
+//
+// MFAnalogMux.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <Arduino.h>
+#include "MFMuxDriver.h"
+
+// Smoothing of the analog values, each new sample is weighted by 1/2^ADC_MUX_FILTER_LOG2
+#ifndef ADC_MUX_FILTER_LOG2
+#define ADC_MUX_FILTER_LOG2 3
+#endif
+
+extern "C" {
+// callback functions
+typedef void (*analogMuxEvent)(uint8_t, int, const char *);
+};
+
+/* **********************************************************************************
+    Up to 16 potentiometers on one ADC pin through a 16 channel multiplexer
+    (e.g. 74HC4067). The channels are read pipelined: each update() reads the
+    channel which was selected by the previous update() and selects the next one,
+    so the mux output settles between two calls without any delay.
+    Therefore the select pins must not be shared with other mux devices,
+    AnalogMux::Add() rejects select pins which are already used.
+********************************************************************************** */
+class MFAnalogMux
+{
+public:
+    MFAnalogMux();
+    static void attachHandler(analogMuxEvent handler);
+    bool        attach(uint8_t pin, uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin, uint8_t channels, uint8_t sensitivity, const char *name);
+    void        detach();
+    void        update();
+    void        retrigger();
+
+private:
+    // filter state per channel, the filtered value has 4 additional fractional bits
+    typedef struct {
+        uint16_t filtered;
+        uint16_t lastValue;
+    } channelState;
+
+    static analogMuxEvent _handler;
+
+    MFMuxDriver   _mux;
+    const char   *_name;
+    channelState *_state;
+    uint8_t       _pin;
+    uint8_t       _channels;
+    uint8_t       _channel; // selected channel, read by the next update()
+    uint8_t       _sensitivity;
+    bool          _initialized = false;
+
+    void trigger(uint8_t channel, uint16_t value);
+};
+
+// MFAnalogMux.h
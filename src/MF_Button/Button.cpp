@@ -7,6 +7,7 @@
 #include "mobiflight.h"
 #include "MFButton.h"
 #include "Button.h"
+#include "IOCore.h"
 
 namespace Button
 {
@@ -18,10 +19,14 @@ namespace Button
     {
         if (!getBoardReady())
             return;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_VALUE, kButtonChange, name, 0, eventId);
+#else
         cmdMessenger.sendCmdStart(kButtonChange);
         cmdMessenger.sendCmdArg(name);
         cmdMessenger.sendCmdArg(eventId);
         cmdMessenger.sendCmdEnd();
+#endif
     };
 
     bool setupArray(uint16_t count)
@@ -52,6 +57,7 @@ namespace Button
             buttons[i].detach();
         }
         buttonsRegistered = 0;
+        maxButtons        = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared buttons"));
 #endif
@@ -2,7 +2,7 @@
 #include "CustomDevice.h"
 #include "MFCustomDevice.h"
 #if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-#include <FreeRTOS.h>
+#include "MFSpscQueue.h"
 #endif
 
 /* **********************************************************************************
@@ -12,13 +12,62 @@
 
 #define MESSAGEID_POWERSAVINGMODE -2
 
+#if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+// number of messages which can be accepted while the 2nd core is busy
+#ifndef MF_CUSTOMDEVICE_PAYLOAD_SLOTS
+#define MF_CUSTOMDEVICE_PAYLOAD_SLOTS 8
+#endif
+#define MF_CUSTOMDEVICE_SLOT_QUEUE 16
+static_assert(MF_CUSTOMDEVICE_PAYLOAD_SLOTS < MF_CUSTOMDEVICE_SLOT_QUEUE, "too many payload slots");
+#endif
+
 namespace CustomDevice
 {
     MFCustomDevice *customDevice;
     uint8_t         customDeviceRegistered = 0;
     uint8_t         maxCustomDevices       = 0;
-#if defined(USE_2ND_CORE)
-    char payload[SERIAL_RX_BUFFER_SIZE];
+#if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    /* **********************************************************************************
+        Messages for the 2nd core are copied into a slot of a pool. The index of the
+        slot is passed to the 2nd core and given back after the message is processed,
+        so a slot is always owned by one core only and no core has to wait for the
+        other one as long as a slot is free.
+    ********************************************************************************** */
+    typedef struct {
+        int16_t device;
+        int16_t messageID;
+        char    payload[SERIAL_RX_BUFFER_SIZE];
+    } payloadSlot;
+
+    payloadSlot                                     slots[MF_CUSTOMDEVICE_PAYLOAD_SLOTS];
+    MFSpscQueue<uint8_t, MF_CUSTOMDEVICE_SLOT_QUEUE> freeSlots; // 2nd core -> 1st core
+    MFSpscQueue<uint8_t, MF_CUSTOMDEVICE_SLOT_QUEUE> usedSlots; // 1st core -> 2nd core
+    volatile bool                                   stopRequested = false; // only written by the 1st core
+    volatile bool                                   stopped       = false; // only written by the 2nd core
+
+    void postMessage(int16_t device, int16_t messageID, const char *payload)
+    {
+        uint8_t slot;
+        // all slots are in use, the 2nd core will give one back soon
+        while (!freeSlots.pop(&slot))
+            ;
+        slots[slot].device    = device;
+        slots[slot].messageID = messageID;
+        strncpy(slots[slot].payload, payload, SERIAL_RX_BUFFER_SIZE - 1);
+        slots[slot].payload[SERIAL_RX_BUFFER_SIZE - 1] = 0;
+        usedSlots.push(slot);
+    }
+
+    // called on the 2nd core, while stopped the slots are only given back
+    void processMessages(bool stop)
+    {
+        uint8_t slot;
+        while (usedSlots.pop(&slot)) {
+            if (!stop && slots[slot].device >= 0 && slots[slot].device < customDeviceRegistered)
+                customDevice[slots[slot].device].set(slots[slot].messageID, slots[slot].payload);
+            freeSlots.push(slot);
+        }
+    }
 #endif
 
     bool setupArray(uint16_t count)
@@ -53,6 +102,7 @@ namespace CustomDevice
             customDevice[i].detach();
         }
         customDeviceRegistered = 0;
+        maxCustomDevices       = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kStatus, F("Cleared CustomDevice"));
 #endif
@@ -93,15 +143,8 @@ namespace CustomDevice
         char   *output    = cmdMessenger.readStringArg(); // get the pointer to the new raw string
         cmdMessenger.unescape(output);                    // and unescape the string if escape characters are used
 #if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-        // copy the message, could get be overwritten from the next message while processing on 2nd core
-        strncpy(payload, output, SERIAL_RX_BUFFER_SIZE);
-        // wait for 2nd core
-        rp2040.fifo.pop();
-        // Hmhm, how to get the function pointer to a function from class??
-        // rp2040.fifo.push((uintptr_t) &customDevice[device].set);
-        rp2040.fifo.push(device);
-        rp2040.fifo.push(messageID);
-        rp2040.fifo.push((uint32_t)&payload);
+        // copy the message, the receive buffer gets overwritten by the next message
+        postMessage(device, messageID, output);
 #else
         customDevice[device].set(messageID, output); // send the string to your custom device
 #endif
@@ -116,27 +159,25 @@ namespace CustomDevice
     void PowerSave(bool state)
     {
         for (uint8_t i = 0; i < customDeviceRegistered; ++i) {
+#if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+            postMessage(i, MESSAGEID_POWERSAVINGMODE, state ? "1" : "0");
+#else
             if (state)
                 customDevice[i].set(MESSAGEID_POWERSAVINGMODE, (char *)"1");
             else
                 customDevice[i].set(MESSAGEID_POWERSAVINGMODE, (char *)"0");
+#endif
         }
     }
 
 #if defined(USE_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
     void stopUpdate2ndCore(bool stop)
     {
-        // wait for 2nd core
-        rp2040.fifo.pop();
-        // send command to stop/start updating to 2nd core
-        // negative device numbers are for commands to 2nd core
-        rp2040.fifo.push(START_STOP_2ND_CORE);
-        // send stop/start
-        rp2040.fifo.push(stop);
-        // communication is always done using 3 messages
-        rp2040.fifo.push(0);
-        // wait for execution of command
-        rp2040.fifo.pop();
+        // this is the only case the 1st core waits for the 2nd core,
+        // pending messages are dropped before the 2nd core stops
+        __atomic_store_n(&stopRequested, stop, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&stopped, __ATOMIC_ACQUIRE) != stop)
+            ;
     }
 #endif
 } // end of namespace
@@ -151,26 +192,33 @@ namespace CustomDevice
 ********************************************************************************** */
 void setup1()
 {
-    // send "ready" message to 1st core
-    rp2040.fifo.push(true);
+    // all slots are owned by the 1st core at the beginning
+    for (uint8_t i = 0; i < MF_CUSTOMDEVICE_PAYLOAD_SLOTS; i++) {
+        CustomDevice::freeSlots.push(i);
+    }
 }
 
 void loop1()
 {
-    int16_t device;
-    int16_t messageID;
-    char   *payload;
-    bool    stopUpdating = false;
 #ifdef MF_CUSTOMDEVICE_POLL_MS
     uint32_t lastMillis = 0;
 #endif
 
     while (1) {
+        // The request is read before the messages are processed and acknowledged after it,
+        // so no message posted before a stop request is set() after the 1st core got the
+        // acknowledge and starts to clear the devices.
+        bool stop = __atomic_load_n(&CustomDevice::stopRequested, __ATOMIC_ACQUIRE);
+        CustomDevice::processMessages(stop);
+        if (stop != CustomDevice::stopped)
+            __atomic_store_n(&CustomDevice::stopped, stop, __ATOMIC_RELEASE);
+        if (stop)
+            continue;
 #ifdef MF_CUSTOMDEVICE_POLL_MS
         if (millis() - lastMillis >= MF_CUSTOMDEVICE_POLL_MS) {
 #endif
 #if defined(MF_CUSTOMDEVICE_HAS_UPDATE)
-            for (int i = 0; i < CustomDevice::customDeviceRegistered && !stopUpdating; i++) {
+            for (int i = 0; i < CustomDevice::customDeviceRegistered; i++) {
                 CustomDevice::customDevice[i].update();
             }
 #endif
@@ -178,24 +226,6 @@ void loop1()
             lastMillis = millis();
         }
 #endif
-        if (rp2040.fifo.available() == 3) {
-            // Hmhm, how to get the function pointer to a function from class??
-            // int32_t (*func)(int16_t, char*) = (int32_t(*)(int16_t, char*)) rp2040.fifo.pop();
-            device    = (int16_t)rp2040.fifo.pop();
-            messageID = (int16_t)rp2040.fifo.pop();
-            payload   = (char *)rp2040.fifo.pop();
-            if (device == -1) {
-                stopUpdating = (bool)messageID;
-                // inform core 0 that command has been executed
-                // it's additional needed in this case
-                rp2040.fifo.push(true);
-            } else {
-                // (*func)(messageID, payload);
-                CustomDevice::customDevice[device].set(messageID, payload);
-            }
-            // send ready for next message to 1st core
-            rp2040.fifo.push(true);
-        }
     }
 }
 #endif
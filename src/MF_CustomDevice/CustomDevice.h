@@ -2,8 +2,6 @@
 
 namespace CustomDevice
 {
-    #define START_STOP_2ND_CORE -1
-
     bool setupArray(uint16_t count);
     void Add(uint16_t adrPin, uint16_t adrType, uint16_t adrConfig, bool configFromFlash);
     void Clear();
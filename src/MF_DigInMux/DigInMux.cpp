@@ -7,40 +7,69 @@
 #include "mobiflight.h"
 #include "MFDigInMux.h"
 #include "MFMuxDriver.h"
-
-extern MFMuxDriver MUX;
+#include "IOCore.h"
 
 namespace DigInMux
 {
-    MFDigInMux *digInMux;
-    uint8_t     digInMuxRegistered = 0;
-    uint8_t     maxDigInMux        = 0;
+    MFDigInMux  *digInMux;
+    uint8_t      digInMuxRegistered = 0;
+    uint8_t      maxDigInMux        = 0;
+    MFMuxDriver *muxDrivers; // one driver for each set of select pins
+    uint8_t      muxDriversRegistered = 0;
 
     void handlerOnDigInMux(uint8_t eventId, uint8_t channel, const char *name)
     {
         if (!getBoardReady())
             return;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_PIN_VALUE, kDigInMuxChange, name, channel, eventId);
+#else
         cmdMessenger.sendCmdStart(kDigInMuxChange);
         cmdMessenger.sendCmdArg(name);
         cmdMessenger.sendCmdArg(channel);
         cmdMessenger.sendCmdArg(eventId);
         cmdMessenger.sendCmdEnd();
+#endif
     };
 
     bool setupArray(uint16_t count)
     {
+        // each allocation gets aligned, so both are checked separately
         if (!FitInMemory(sizeof(MFDigInMux) * count))
             return false;
-        digInMux    = new (allocateMemory(sizeof(MFDigInMux) * count)) MFDigInMux;
+        digInMux = new (allocateMemory(sizeof(MFDigInMux) * count)) MFDigInMux;
+        if (!FitInMemory(sizeof(MFMuxDriver) * count))
+            return false;
+        muxDrivers  = new (allocateMemory(sizeof(MFMuxDriver) * count)) MFMuxDriver;
         maxDigInMux = count;
         return true;
     }
 
-    void Add(uint8_t dataPin, uint8_t nRegs, char const *name)
+    // returns the driver which is attached to the select pins, a new one is attached if none exists.
+    // Returns NULL if some of the select pins are used by another mux driver.
+    MFMuxDriver *getMuxDriver(uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin)
+    {
+        for (uint8_t i = 0; i < muxDriversRegistered; i++) {
+            if (muxDrivers[i].hasSelPins(Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin))
+                return &muxDrivers[i];
+        }
+        if (MFMuxDriver::selPinsUsed(Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin))
+            return NULL;
+        muxDrivers[muxDriversRegistered] = MFMuxDriver();
+        muxDrivers[muxDriversRegistered].attach(Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin);
+        return &muxDrivers[muxDriversRegistered++];
+    }
+
+    void Add(uint8_t dataPin, uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin, uint8_t nRegs, char const *name)
     {
         if (digInMuxRegistered == maxDigInMux)
             return;
-        digInMux[digInMuxRegistered] = MFDigInMux(&MUX, name);
+        MFMuxDriver *muxDriver = getMuxDriver(Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin);
+        if (!muxDriver) {
+            cmdMessenger.sendCmd(kStatus, F("DigInMux select pins are used by another mux"));
+            return;
+        }
+        digInMux[digInMuxRegistered] = MFDigInMux(muxDriver, name);
         digInMux[digInMuxRegistered].attach(dataPin, (nRegs == 1), name);
         MFDigInMux::attachHandler(handlerOnDigInMux);
         digInMuxRegistered++;
@@ -56,15 +85,47 @@ namespace DigInMux
             digInMux[i].detach();
         }
         digInMuxRegistered = 0;
+        maxDigInMux        = 0;
+        for (uint8_t i = 0; i < muxDriversRegistered; i++) {
+            muxDrivers[i].detach();
+        }
+        muxDriversRegistered = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared dig. input Muxes"));
 #endif
     }
 
+    // DigInMux with the same select pins share one mux driver. The drivers are swept in
+    // parallel, all of them select the same channel, so the settling time is waited only
+    // once per channel. Afterwards the data pins of all registered DigInMux are read.
     void read()
     {
+        uint8_t selMax = 0;
+
+        for (uint8_t i = 0; i < digInMuxRegistered; i++) {
+            if (digInMux[i].getChannels() > selMax)
+                selMax = digInMux[i].getChannels();
+        }
+        if (!selMax)
+            return;
+
+        // The channels are swept in Gray code order, so only one select line changes per step
+        for (uint8_t d = 0; d < muxDriversRegistered; d++)
+            muxDrivers[d].saveChannel();
+        for (uint8_t step = 0; step < selMax; step++) {
+            uint8_t sel = MFMuxDriver::grayChannel(step);
+            for (uint8_t d = 0; d < muxDriversRegistered; d++)
+                muxDrivers[d].setChannel(sel);
+            delayMicroseconds(MF_MUX_SETTLE_US); // see MFDigInMux::poll()
+            for (uint8_t i = 0; i < digInMuxRegistered; i++) {
+                digInMux[i].sample(sel);
+            }
+        }
+        for (uint8_t d = 0; d < muxDriversRegistered; d++)
+            muxDrivers[d].restoreChannel();
+
         for (uint8_t i = 0; i < digInMuxRegistered; i++) {
-            digInMux[i].update();
+            digInMux[i].commitSample(true);
         }
     }
 
@@ -11,7 +11,7 @@
 namespace DigInMux
 {
     bool setupArray(uint16_t count);
-    void Add(uint8_t dataPin, uint8_t nRegs, char const *name = "DigInMux");
+    void Add(uint8_t dataPin, uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin, uint8_t nRegs, char const *name = "DigInMux");
     void Clear();
     void read();
     void OnTrigger();
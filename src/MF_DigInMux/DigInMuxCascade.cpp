@@ -0,0 +1,96 @@
+//
+// DigInMuxCascade.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "mobiflight.h"
+#include "MFDigInMuxCascade.h"
+#include "IOCore.h"
+
+namespace DigInMuxCascade
+{
+    MFDigInMuxCascade *muxCascade;
+    uint8_t            muxCascadeRegistered = 0;
+    uint8_t            maxMuxCascade        = 0;
+
+    // same event as for a DigInMux, the channel is 0-255
+    void handlerOnMuxCascade(uint8_t eventId, uint8_t channel, const char *name)
+    {
+        if (!getBoardReady())
+            return;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_PIN_VALUE, kDigInMuxChange, name, channel, eventId);
+#else
+        cmdMessenger.sendCmdStart(kDigInMuxChange);
+        cmdMessenger.sendCmdArg(name);
+        cmdMessenger.sendCmdArg(channel);
+        cmdMessenger.sendCmdArg(eventId);
+        cmdMessenger.sendCmdEnd();
+#endif
+    };
+
+    bool setupArray(uint16_t count)
+    {
+        if (!FitInMemory(sizeof(MFDigInMuxCascade) * count))
+            return false;
+        muxCascade    = new (allocateMemory(sizeof(MFDigInMuxCascade) * count)) MFDigInMuxCascade;
+        maxMuxCascade = count;
+        return true;
+    }
+
+    void Add(uint8_t dataPin, const uint8_t *selPins, uint8_t muxCount, char const *name)
+    {
+        if (muxCascadeRegistered == maxMuxCascade)
+            return;
+        // the select lines are driven by own mux drivers, they can't be shared with other muxes
+        if (MFMuxDriver::selPinsUsed(selPins[0], selPins[1], selPins[2], selPins[3]) ||
+            MFMuxDriver::selPinsUsed(selPins[4], selPins[5], selPins[6], selPins[7])) {
+            cmdMessenger.sendCmd(kStatus, F("DigInMuxCascade select pins are used by another mux"));
+            return;
+        }
+        muxCascade[muxCascadeRegistered] = MFDigInMuxCascade();
+        if (!muxCascade[muxCascadeRegistered].attach(dataPin, selPins, muxCount, name)) {
+            if (!GetMemoryTrial())
+                cmdMessenger.sendCmd(kStatus, F("DigInMuxCascade does not fit in Memory"));
+            return;
+        }
+        MFDigInMuxCascade::attachHandler(handlerOnMuxCascade);
+        muxCascadeRegistered++;
+
+#ifdef DEBUG2CMDMESSENGER
+        cmdMessenger.sendCmd(kDebug, F("Added digital input MUX cascade"));
+#endif
+    }
+
+    void Clear()
+    {
+        for (uint8_t i = 0; i < muxCascadeRegistered; i++) {
+            muxCascade[i].detach();
+        }
+        muxCascadeRegistered = 0;
+        maxMuxCascade        = 0;
+#ifdef DEBUG2CMDMESSENGER
+        cmdMessenger.sendCmd(kDebug, F("Cleared dig. input MUX cascades"));
+#endif
+    }
+
+    // Each call reads one slice of the second level muxes, so a full sweep
+    // takes MF_INMUX_CASCADE_SLICES calls
+    void read()
+    {
+        for (uint8_t i = 0; i < muxCascadeRegistered; i++) {
+            uint8_t muxCount = muxCascade[i].getMuxCount();
+            muxCascade[i].update((muxCount + MF_INMUX_CASCADE_SLICES - 1) / MF_INMUX_CASCADE_SLICES);
+        }
+    }
+
+    void OnTrigger()
+    {
+        for (uint8_t i = 0; i < muxCascadeRegistered; i++) {
+            muxCascade[i].retrigger();
+        }
+    }
+} // namespace
+
+// DigInMuxCascade.cpp
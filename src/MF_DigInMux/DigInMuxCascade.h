@@ -0,0 +1,20 @@
+//
+// DigInMuxCascade.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+#include <stdint.h>
+#include "MFDigInMuxCascade.h"
+
+namespace DigInMuxCascade
+{
+    bool setupArray(uint16_t count);
+    void Add(uint8_t dataPin, const uint8_t *selPins, uint8_t muxCount, char const *name = "DigInMuxCascade");
+    void Clear();
+    void read();
+    void OnTrigger();
+}
+
+// DigInMuxCascade.h
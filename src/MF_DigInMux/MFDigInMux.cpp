@@ -8,8 +8,6 @@
 #include "MFDigInMux.h"
 #include "MFMuxDriver.h"
 
-MFMuxDriver *MFDigInMux::_MUX;
-
 MuxDigInEvent MFDigInMux::_inputHandler = NULL;
 
 MFDigInMux::MFDigInMux(void)
@@ -23,16 +21,11 @@ MFDigInMux::MFDigInMux(void)
 MFDigInMux::MFDigInMux(MFMuxDriver *MUX, const char *name)
     : _name(name)
 {
-    if (MUX) _MUX = MUX;
+    _MUX   = MUX;
     _flags = 0x00;
     clear();
 }
 
-void MFDigInMux::setMux(MFMuxDriver *MUX)
-{
-    _MUX = MUX;
-}
-
 // Registers a new MUX input block and configures the driver pins
 void MFDigInMux::attach(uint8_t dataPin, bool halfSize, char const *name)
 {
@@ -42,6 +35,10 @@ void MFDigInMux::attach(uint8_t dataPin, bool halfSize, char const *name)
     _flags   = 0x00;
     if (halfSize) bitSet(_flags, MUX_HALFSIZE);
     pinMode(_dataPin, INPUT_PULLUP);
+#if defined(ARDUINO_ARCH_AVR)
+    _dataPort = portInputRegister(digitalPinToPort(_dataPin));
+    _dataMask = digitalPinToBitMask(_dataPin);
+#endif
     bitSet(_flags, MUX_INITED);
 
     // Initialize all inputs with current status
@@ -69,13 +66,13 @@ void MFDigInMux::poll(bool doTrigger)
 {
     if (!_MUX) return;
 
-    uint8_t          selMax       = (bitRead(_flags, MUX_HALFSIZE) ? 8 : 16);
-    uint16_t         currentState = 0x0000;
-    volatile uint8_t pinVal;
+    uint8_t selMax = getChannels();
 
+    // The channels are swept in Gray code order, so only one select line changes per step
     _MUX->saveChannel();
-    for (uint8_t sel = selMax; sel > 0; sel--) {
-        _MUX->setChannel(sel - 1);
+    for (uint8_t step = 0; step < selMax; step++) {
+        uint8_t sel = MFMuxDriver::grayChannel(step);
+        _MUX->setChannel(sel);
 
         // Allow the output to settle from voltage transients:
         // transients towards 0 (GND) are negligible, but transients towards 1 (Vcc)
@@ -84,21 +81,39 @@ void MFDigInMux::poll(bool doTrigger)
         // integrated PU -> 1.4us
         // external, 10k -> 400ns
         // external, 4k7 -> 250ns
-        // A digitalRead() takes about 5us, therefore even the integrated pullup should be sufficient;
-        // for added safety, we perform one more (useless) digitalRead().
+        // As the data pin is read directly from the port register, a delay is required.
         // NB An external pullup (10k or 4k7) is recommended anyway for better interference immunity.
-
-        pinVal = digitalRead(_dataPin);
-        pinVal = digitalRead(_dataPin);
-        // delayMicroseconds(5);  // This is overkill
-        currentState <<= 1;
-        currentState |= (pinVal ? 1 : 0);
+        delayMicroseconds(MF_MUX_SETTLE_US);
+        sample(sel);
     }
     _MUX->restoreChannel(); // tidy up
 
-    if (_lastState != currentState) {
-        if (doTrigger) detectChanges(_lastState, currentState);
-        _lastState = currentState;
+    commitSample(doTrigger);
+}
+
+// Reads the data pin for the currently selected channel of the MUX,
+// the state gets evaluated by commitSample() after all channels are read
+void MFDigInMux::sample(uint8_t channel)
+{
+    if (channel >= getChannels()) return;
+
+#if defined(ARDUINO_ARCH_AVR)
+    bool pinVal = (*_dataPort & _dataMask) != 0;
+#else
+    bool pinVal = digitalRead(_dataPin);
+#endif
+    if (pinVal)
+        _sampledState |= (1 << channel);
+    else
+        _sampledState &= ~(1 << channel);
+}
+
+// Compares the sampled channels against the last state and triggers the changes
+void MFDigInMux::commitSample(bool doTrigger)
+{
+    if (_lastState != _sampledState) {
+        if (doTrigger) detectChanges(_lastState, _sampledState);
+        _lastState = _sampledState;
     }
 }
 
@@ -106,14 +121,14 @@ void MFDigInMux::poll(bool doTrigger)
 void MFDigInMux::detectChanges(uint16_t lastState, uint16_t currentState)
 {
     if (!_MUX) return;
-    uint8_t  selMax = (bitRead(_flags, MUX_HALFSIZE) ? 8 : 16);
-    uint16_t diff   = lastState ^ currentState;
-    for (uint8_t i = 0; i < selMax; i++) {
-        if (diff & 0x0001) {
-            trigger(i, ((currentState & 0x0001) != 0));
-        }
-        diff >>= 1;
-        currentState >>= 1;
+    uint16_t diff = lastState ^ currentState;
+    if (bitRead(_flags, MUX_HALFSIZE)) diff &= 0x00FF;
+
+    // Only the changed bits are visited, the lowest one is cleared after each trigger
+    while (diff) {
+        uint8_t i = __builtin_ctz(diff);
+        trigger(i, ((currentState >> i) & 0x0001) != 0);
+        diff &= diff - 1;
     }
 }
 
@@ -152,7 +167,8 @@ void MFDigInMux::attachHandler(MuxDigInEvent newHandler)
 // Clears the internal state
 void MFDigInMux::clear()
 {
-    _lastState = 0;
+    _lastState    = 0;
+    _sampledState = 0;
 }
 
 // MFDigInMux.cpp
\ No newline at end of file
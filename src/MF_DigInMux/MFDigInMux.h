@@ -13,6 +13,11 @@ extern "C" {
 typedef void (*MuxDigInEvent)(byte, uint8_t, const char *);
 };
 
+// Settling time of the MUX output after a channel is selected
+#ifndef MF_MUX_SETTLE_US
+#define MF_MUX_SETTLE_US 2
+#endif
+
 enum {
     MuxDigInOnPress,
     MuxDigInOnRelease,
@@ -23,15 +28,18 @@ class MFDigInMux
 public:
     MFDigInMux(void);
     MFDigInMux(MFMuxDriver *MUX, const char *name);
-    static void setMux(MFMuxDriver *MUX);
     static void attachHandler(MuxDigInEvent newHandler);
 
-    void     attach(uint8_t dataPin, bool halfSize, char const *name);
-    void     detach();
-    void     clear();
-    void     retrigger();
-    void     update();
-    uint16_t getValues(void) { return _lastState; }
+    void         attach(uint8_t dataPin, bool halfSize, char const *name);
+    void         detach();
+    void         clear();
+    void         retrigger();
+    void         update();
+    void         sample(uint8_t channel);
+    void         commitSample(bool doTrigger);
+    uint16_t     getValues(void) { return _lastState; }
+    uint8_t      getChannels(void) { return bitRead(_flags, MUX_HALFSIZE) ? 8 : 16; }
+    MFMuxDriver *getMux(void) { return _MUX; }
 
 private:
     enum { MUX_INITED   = 0,
@@ -41,13 +49,18 @@ private:
     enum { DONT_TRIGGER = 0,
            DO_TRIGGER   = 1 };
 
-    static MFMuxDriver  *_MUX;
     static MuxDigInEvent _inputHandler;
 
-    const char *_name;
-    uint8_t     _dataPin; // Data pin - MUX common, input to AVR
-    uint8_t     _flags;
-    uint16_t    _lastState;
+    MFMuxDriver *_MUX;
+    const char  *_name;
+    uint8_t      _dataPin; // Data pin - MUX common, input to AVR
+    uint8_t      _flags;
+    uint16_t     _lastState;
+    uint16_t     _sampledState; // channels read during a sweep, evaluated by commitSample()
+#if defined(ARDUINO_ARCH_AVR)
+    volatile uint8_t *_dataPort; // input register and bit of the data pin for fast reads
+    uint8_t           _dataMask;
+#endif
 
     void poll(bool detect);
     void detectChanges(uint16_t lastState, uint16_t currentState);
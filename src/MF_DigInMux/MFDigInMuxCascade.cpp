@@ -0,0 +1,136 @@
+//
+// MFDigInMuxCascade.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "mobiflight.h"
+#include "MFDigInMuxCascade.h"
+
+MuxDigInEvent MFDigInMuxCascade::_inputHandler = NULL;
+
+MFDigInMuxCascade::MFDigInMuxCascade(void)
+{
+    _name     = "MUXCascade";
+    _muxCount = 0;
+    _nextMux  = 0;
+}
+
+bool MFDigInMuxCascade::attach(uint8_t dataPin, const uint8_t *selPins, uint8_t muxCount, const char *name)
+{
+    if (muxCount == 0 || muxCount > 16)
+        return false;
+    if (!FitInMemory(sizeof(uint16_t) * muxCount))
+        return false;
+
+    _lastState = new (allocateMemory(sizeof(uint16_t) * muxCount)) uint16_t;
+    _dataPin   = dataPin;
+    _name      = name;
+    _muxCount  = muxCount;
+    _nextMux   = 0;
+
+    _level2.attach(selPins[0], selPins[1], selPins[2], selPins[3]);
+    _level1.attach(selPins[4], selPins[5], selPins[6], selPins[7]);
+    pinMode(_dataPin, INPUT_PULLUP);
+#if defined(ARDUINO_ARCH_AVR)
+    _dataPort = portInputRegister(digitalPinToPort(_dataPin));
+    _dataMask = digitalPinToBitMask(_dataPin);
+#endif
+
+    // Initialize all inputs with current status
+    for (uint8_t mux = 0; mux < _muxCount; mux++)
+        _lastState[mux] = sampleMux(mux);
+    _initialized = true;
+    return true;
+}
+
+void MFDigInMuxCascade::detach()
+{
+    if (!_initialized)
+        return;
+    _level1.detach();
+    _level2.detach();
+    pinMode(_dataPin, INPUT_PULLUP);
+    _initialized = false;
+}
+
+// Reads all 16 channels of one second level mux, the channels are swept in Gray code order.
+// From the last channel of one mux to the first one of the next mux also only one select line
+// of the second level changes, in addition to the first level select lines.
+uint16_t MFDigInMuxCascade::sampleMux(uint8_t mux)
+{
+    uint16_t state = 0;
+
+    _level1.setChannel(mux);
+    for (uint8_t step = 0; step < 16; step++) {
+        uint8_t sel = MFMuxDriver::grayChannel(step);
+        _level2.setChannel(sel);
+        delayMicroseconds(MF_MUX_SETTLE_US); // see MFDigInMux::poll()
+#if defined(ARDUINO_ARCH_AVR)
+        bool pinVal = (*_dataPort & _dataMask) != 0;
+#else
+        bool pinVal = digitalRead(_dataPin);
+#endif
+        if (pinVal)
+            state |= (1 << sel);
+    }
+    return state;
+}
+
+// Reads the next muxCount second level muxes, the changes are detected per mux (word wise)
+void MFDigInMuxCascade::update(uint8_t muxCount)
+{
+    if (!_initialized)
+        return;
+
+    for (uint8_t i = 0; i < muxCount && i < _muxCount; i++) {
+        uint8_t  mux   = _nextMux;
+        uint16_t state = sampleMux(mux);
+        if (state != _lastState[mux]) {
+            detectChanges(mux, _lastState[mux], state);
+            _lastState[mux] = state;
+        }
+        if (++_nextMux >= _muxCount)
+            _nextMux = 0;
+    }
+}
+
+// Only the changed bits are visited, the lowest one is cleared after each trigger
+void MFDigInMuxCascade::detectChanges(uint8_t mux, uint16_t lastState, uint16_t currentState)
+{
+    uint16_t diff = lastState ^ currentState;
+
+    while (diff) {
+        uint8_t i = __builtin_ctz(diff);
+        trigger((mux << 4) | i, ((currentState >> i) & 0x0001) != 0);
+        diff &= diff - 1;
+    }
+}
+
+// Reads the current state of all inputs then fires 'release' events for every 'off' input,
+// followed by 'press' events for every 'on' input (like MFDigInMux::retrigger())
+void MFDigInMuxCascade::retrigger()
+{
+    if (!_initialized)
+        return;
+
+    for (uint8_t mux = 0; mux < _muxCount; mux++)
+        _lastState[mux] = sampleMux(mux);
+    for (uint8_t mux = 0; mux < _muxCount; mux++)
+        detectChanges(mux, 0x0000, _lastState[mux]);
+    for (uint8_t mux = 0; mux < _muxCount; mux++)
+        detectChanges(mux, 0xFFFF, _lastState[mux]);
+}
+
+void MFDigInMuxCascade::trigger(uint8_t channel, bool state)
+{
+    if (!_inputHandler) return;
+    (*_inputHandler)((state ? MuxDigInOnRelease : MuxDigInOnPress), channel, _name);
+}
+
+void MFDigInMuxCascade::attachHandler(MuxDigInEvent newHandler)
+{
+    _inputHandler = newHandler;
+}
+
+// MFDigInMuxCascade.cpp
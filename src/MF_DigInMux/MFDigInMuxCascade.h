@@ -0,0 +1,62 @@
+//
+// MFDigInMuxCascade.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <Arduino.h>
+#include "MFMuxDriver.h"
+#include "MFDigInMux.h"
+
+// A full sweep is split into this number of slices, one slice is read per call of the
+// scheduled task, so a sweep of 256 inputs does not block the loop for too long
+#ifndef MF_INMUX_CASCADE_SLICES
+#define MF_INMUX_CASCADE_SLICES 4
+#endif
+
+/* **********************************************************************************
+    Two level cascade of 16 channel multiplexers (e.g. 74HC4067). The outputs of up
+    to 16 second level muxes are connected to the inputs of the first level mux,
+    whose output is connected to the data pin. All second level muxes share the
+    select pins 0-3, the first level mux is selected by the pins 4-7.
+    Channel n is input (n % 16) of the second level mux (n / 16).
+********************************************************************************** */
+class MFDigInMuxCascade
+{
+public:
+    MFDigInMuxCascade(void);
+    static void attachHandler(MuxDigInEvent newHandler);
+
+    bool    attach(uint8_t dataPin, const uint8_t *selPins, uint8_t muxCount, const char *name);
+    void    detach();
+    void    update(uint8_t muxCount);
+    void    retrigger();
+    uint8_t getMuxCount(void) { return _muxCount; }
+
+private:
+    enum { DONT_TRIGGER = 0,
+           DO_TRIGGER   = 1 };
+
+    static MuxDigInEvent _inputHandler;
+
+    MFMuxDriver _level1;      // selects the second level mux
+    MFMuxDriver _level2;      // selects the channel of all second level muxes
+    const char *_name;
+    uint8_t     _dataPin;     // output of the first level mux
+    uint8_t     _muxCount;    // number of second level muxes
+    uint8_t     _nextMux;     // second level mux which is read next
+    bool        _initialized = false;
+    uint16_t   *_lastState;   // one word per second level mux, bit n is channel n of this mux
+#if defined(ARDUINO_ARCH_AVR)
+    volatile uint8_t *_dataPort; // input register and bit of the data pin for fast reads
+    uint8_t           _dataMask;
+#endif
+
+    uint16_t sampleMux(uint8_t mux);
+    void     detectChanges(uint8_t mux, uint16_t lastState, uint16_t currentState);
+    void     trigger(uint8_t channel, bool state);
+};
+
+// MFDigInMuxCascade.h
@@ -7,6 +7,7 @@
 #include "mobiflight.h"
 #include "MFEncoder.h"
 #include "Encoder.h"
+#include "IOCore.h"
 
 namespace Encoder
 {
@@ -18,10 +19,14 @@ namespace Encoder
     {
         if (!getBoardReady())
             return;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_VALUE, kEncoderChange, name, 0, eventId);
+#else
         cmdMessenger.sendCmdStart(kEncoderChange);
         cmdMessenger.sendCmdArg(name);
         cmdMessenger.sendCmdArg(eventId);
         cmdMessenger.sendCmdEnd();
+#endif
     };
 
     bool setupArray(uint16_t count)
@@ -49,6 +54,7 @@ namespace Encoder
     void Clear()
     {
         encodersRegistered = 0;
+        maxEncoders        = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared encoders"));
 #endif
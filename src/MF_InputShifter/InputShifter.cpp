@@ -7,24 +7,63 @@
 #include "mobiflight.h"
 #include "MFInputShifter.h"
 #include "InputShifter.h"
+#include "IOCore.h"
 
 namespace InputShifter
 {
     MFInputShifter *inputShifter;
     uint8_t         inputShifterRegistered = 0;
     uint8_t         maxInputShifter        = 0;
+    bool            compactEvents          = false; // enabled by the connector, reset with each config and kGetInfo
+    bool            compactEventStarted    = false;
 
     void handlerInputShifterOnChange(uint8_t eventId, uint8_t pin, const char *name)
     {
         if (!getBoardReady())
             return;
+        if (compactEvents) {
+            // all changes of one input shifter are collected in one message,
+            // which gets closed by endCompactEvent()
+            if (!compactEventStarted) {
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+                IOCore::pushEvent(IOCore::EVENT_COMPACT_START, kInputShifterChanges, name, 0, 0);
+#else
+                cmdMessenger.sendCmdStart(kInputShifterChanges);
+                cmdMessenger.sendCmdArg(name);
+#endif
+                compactEventStarted = true;
+            }
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+            IOCore::pushEvent(IOCore::EVENT_COMPACT_ARG, 0, 0, pin, eventId);
+#else
+            cmdMessenger.sendCmdArg(pin);
+            cmdMessenger.sendCmdArg(eventId);
+#endif
+            return;
+        }
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_PIN_VALUE, kInputShifterChange, name, pin, eventId);
+#else
         cmdMessenger.sendCmdStart(kInputShifterChange);
         cmdMessenger.sendCmdArg(name);
         cmdMessenger.sendCmdArg(pin);
         cmdMessenger.sendCmdArg(eventId);
         cmdMessenger.sendCmdEnd();
+#endif
     };
 
+    void endCompactEvent()
+    {
+        if (compactEventStarted) {
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+            IOCore::pushEvent(IOCore::EVENT_COMPACT_END, 0, 0, 0, 0);
+#else
+            cmdMessenger.sendCmdEnd();
+#endif
+            compactEventStarted = false;
+        }
+    }
+
     bool setupArray(uint16_t count)
     {
         if (!FitInMemory(sizeof(MFInputShifter) * count))
@@ -40,7 +79,8 @@ namespace InputShifter
             return;
         inputShifter[inputShifterRegistered] = MFInputShifter();
         if (!inputShifter[inputShifterRegistered].attach(latchPin, clockPin, dataPin, modules, name)) {
-            cmdMessenger.sendCmd(kStatus, F("InputShifter array does not fit into Memory"));
+            if (!GetMemoryTrial())
+                cmdMessenger.sendCmd(kStatus, F("InputShifter array does not fit into Memory"));
             return;
         }
         MFInputShifter::attachHandler(handlerInputShifterOnChange);
@@ -56,6 +96,7 @@ namespace InputShifter
             inputShifter[i].detach();
         }
         inputShifterRegistered = 0;
+        maxInputShifter        = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared input shifter"));
 #endif
@@ -65,6 +106,7 @@ namespace InputShifter
     {
         for (uint8_t i = 0; i < inputShifterRegistered; i++) {
             inputShifter[i].update();
+            endCompactEvent();
         }
     }
 
@@ -76,13 +118,29 @@ namespace InputShifter
         // Trigger all button release events first...
         for (uint8_t i = 0; i < inputShifterRegistered; i++) {
             inputShifter[i].triggerOnRelease();
+            endCompactEvent();
         }
         // ... then trigger all the press events
         for (uint8_t i = 0; i < inputShifterRegistered; i++) {
             inputShifter[i].triggerOnPress();
+            endCompactEvent();
         }
     }
 
+    // The connector enables (1) or disables (0) to get all changed inputs of
+    // an input shifter with one kInputShifterChanges message: name,pin,event,pin,event,...
+    void OnSetCompactEvents()
+    {
+        compactEvents = cmdMessenger.readBoolArg();
+    }
+
+    // A connector which does not know kInputShifterChanges must get the single events,
+    // so it has to be enabled again after each new config and connection
+    void ResetCompactEvents()
+    {
+        compactEvents = false;
+    }
+
 } // namespace
 
 // InputShifter.cpp
@@ -13,6 +13,8 @@ namespace InputShifter
     void Clear();
     void read();
     void OnTrigger();
+    void OnSetCompactEvents();
+    void ResetCompactEvents();
 }
 
 // InputShifter.h
\ No newline at end of file
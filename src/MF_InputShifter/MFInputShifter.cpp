@@ -6,6 +6,12 @@
 
 #include "MFInputShifter.h"
 #include "allocateMem.h"
+#if defined(ARDUINO_ARCH_AVR)
+#include <SPI.h>
+#include "config.h"
+#elif defined(ARDUINO_ARCH_RP2040)
+#include "MFSpiBlock.h"
+#endif
 
 inputShifterEvent MFInputShifter::_inputHandler = NULL;
 
@@ -27,6 +33,7 @@ bool MFInputShifter::attach(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin,
     pinMode(_latchPin, OUTPUT);
     pinMode(_clockPin, OUTPUT);
     pinMode(_dataPin, INPUT);
+    _useSPI = attachSPI();
 
     if (!FitInMemory(sizeof(uint8_t) * _moduleCount))
         return false;
@@ -45,9 +52,72 @@ bool MFInputShifter::attach(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin,
 
 void MFInputShifter::detach()
 {
+    if (_useSPI) {
+        detachSPI();
+        _useSPI = false;
+    }
     _initialized = false;
 }
 
+// Checks if clock and data pin are the pins of a hardware SPI and hands them over to it.
+// Otherwise the registers are bit-banged via shiftIn(), which works on any pin.
+bool MFInputShifter::attachSPI()
+{
+#if defined(ARDUINO_ARCH_AVR)
+    if (_clockPin != SCK || _dataPin != MISO)
+        return false;
+    // SPI.begin() also sets MOSI and SS to output, otherwise the SPI could fall back into slave mode.
+    // So the hardware SPI is only used if no other device is connected to SS or MOSI.
+    if (!spiPinsAvailable())
+        return false;
+    SPI.begin();
+    return true;
+#elif defined(ARDUINO_ARCH_RP2040)
+    // Each GPIO has a fixed SPI function: bits 0..1 select RX/CSn/SCK/TX and bit 3 the SPI block
+    if (_clockPin > 29 || _dataPin > 29)
+        return false;
+    if ((_clockPin & 0x03) != 2 || (_dataPin & 0x03) != 0 || ((_clockPin ^ _dataPin) & 0x08))
+        return false;
+    _spi = (_clockPin & 0x08) ? spi1 : spi0;
+    if (!MFSpiBlock::claim(_spi, MFSpiBlock::USER_INPUT_SHIFTER, MF_INPUTSHIFTER_SPI_CLOCK))
+        return false;
+    // only clock and data are routed to the SPI, TX and CS pins stay free for other devices
+    gpio_set_function(_clockPin, GPIO_FUNC_SPI);
+    gpio_set_function(_dataPin, GPIO_FUNC_SPI);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MFInputShifter::detachSPI()
+{
+#if defined(ARDUINO_ARCH_AVR)
+    SPI.end();
+#elif defined(ARDUINO_ARCH_RP2040)
+    // the block and the pins are only released if no output shifter is using them,
+    // the pins get reconfigured anyway by the next device using them
+    if (MFSpiBlock::release(_spi)) {
+        pinMode(_clockPin, OUTPUT);
+        pinMode(_dataPin, INPUT);
+    }
+#endif
+}
+
+uint8_t MFInputShifter::readByte()
+{
+    if (_useSPI) {
+#if defined(ARDUINO_ARCH_AVR)
+        return SPI.transfer(0);
+#elif defined(ARDUINO_ARCH_RP2040)
+        uint8_t value;
+        spi_read_blocking(_spi, 0, &value, 1);
+        return value;
+#endif
+    }
+    return shiftIn(_dataPin, _clockPin, MSBFIRST);
+}
+
 // Reads the values from the attached modules, compares them to the previously
 // read values, and calls the registered event handler for any inputs that
 // changed from the previously read state.
@@ -58,43 +128,57 @@ void MFInputShifter::update()
 
 void MFInputShifter::poll(uint8_t doTrigger)
 {
-    digitalWrite(_clockPin, HIGH); // Preset clock to retrieve first bit
-    digitalWrite(_latchPin, HIGH); // Disable input latching and enable shifting
-
-    // Multiple chained modules are handled one at a time. As shiftIn() keeps getting
+    // The SPI idles the clock high and samples on the falling edge (mode 2),
+    // the same timing as shiftIn() with a preset clock. The registers shift on the rising edge.
+    // The settings are applied on each read as output shifters or other libraries
+    // might use the SPI with different settings.
+#if defined(ARDUINO_ARCH_AVR)
+    if (_useSPI) SPI.beginTransaction(SPISettings(MF_INPUTSHIFTER_SPI_CLOCK, MSBFIRST, SPI_MODE2));
+#elif defined(ARDUINO_ARCH_RP2040)
+    if (_useSPI) spi_set_format(_spi, 8, SPI_CPOL_1, SPI_CPHA_0, SPI_MSB_FIRST);
+#endif
+    if (!_useSPI) digitalWrite(_clockPin, HIGH); // Preset clock to retrieve first bit
+    digitalWrite(_latchPin, HIGH);               // Disable input latching and enable shifting
+
+    // Multiple chained modules are handled one at a time. As readByte() keeps getting
     // called it will pull in the data from each chained module.
-    for (uint8_t module = 0; module < _moduleCount; module++) {
-        uint8_t currentState;
-
-        currentState = shiftIn(_dataPin, _clockPin, MSBFIRST);
+    // Up to four modules are combined to one 32 bit word, so unchanged inputs
+    // are skipped with a single compare.
+    for (uint8_t module = 0; module < _moduleCount; module += 4) {
+        uint32_t lastState    = 0;
+        uint32_t currentState = 0;
+
+        for (uint8_t i = 0; i < 4 && module + i < _moduleCount; i++) {
+            uint8_t value = readByte();
+            lastState |= (uint32_t)_lastState[module + i] << (i * 8);
+            currentState |= (uint32_t)value << (i * 8);
+            _lastState[module + i] = value;
+        }
 
-        // If an input changed on the current module from the last time it was read
+        // If an input changed on the current modules from the last time it was read
         // then hand it off to figure out which bits specifically changed.
-        if (currentState != _lastState[module]) {
-            if (doTrigger) detectChanges(_lastState[module], currentState, module);
-            _lastState[module] = currentState;
-        }
+        if (doTrigger && currentState != lastState) detectChanges(lastState, currentState, module * 8);
     }
 
     digitalWrite(_latchPin, LOW); // disable shifting and enable input latching
+#if defined(ARDUINO_ARCH_AVR)
+    if (_useSPI) SPI.endTransaction();
+#endif
 }
 
 // Detects changes between the current state and the previously saved state
-// of a byte's worth of input.
-void MFInputShifter::detectChanges(uint8_t lastState, uint8_t currentState, uint8_t module)
+// of up to four modules, starting with 'firstPin'.
+void MFInputShifter::detectChanges(uint32_t lastState, uint32_t currentState, uint8_t firstPin)
 {
-    for (uint8_t i = 0; i < 8; i++) {
-        // If last and current input state for the bit are different
-        // then the input changed and the handler for the bit needs to fire
-        if ((lastState & 1) ^ (currentState & 1)) {
-            // When triggering event the pin is the actual pin on the chip offset by 8 bits for each
-            // module beyond the first that it's on. The state of the trigger is the bit currently
-            // in position 0 of currentState.
-            trigger(i + (module * 8), currentState & 1);
-        }
-
-        lastState    = lastState >> 1;
-        currentState = currentState >> 1;
+    uint32_t diff = lastState ^ currentState;
+
+    // Only the changed bits are visited, the lowest one is cleared after each trigger
+    while (diff) {
+        uint8_t bit = __builtin_ctzl(diff);
+        // When triggering event the pin is the actual pin on the chip offset by 8 bits for each
+        // module beyond the first that it's on.
+        trigger(firstPin + bit, (currentState >> bit) & 1);
+        diff &= diff - 1;
     }
 }
 
@@ -110,20 +194,15 @@ void MFInputShifter::triggerOnPress()
     if (!_initialized || !_inputHandler)
         return;
 
-    uint8_t state;
-
     poll(DONT_TRIGGER);
 
-    // Trigger all the pressed buttons
-    for (int module = 0; module < _moduleCount; module++) {
-        state = _lastState[module];
-        for (uint8_t i = 0; i < 8; i++) {
-            // Only trigger if the button is in the on position
-            if (!(state & 1)) {
-                trigger(i + (module * 8), LOW);
-            }
-
-            state = state >> 1;
+    // Trigger all the pressed buttons, these are the bits in the off position
+    for (uint8_t module = 0; module < _moduleCount; module++) {
+        uint8_t pressed = ~_lastState[module];
+        while (pressed) {
+            uint8_t bit = __builtin_ctz(pressed);
+            trigger(bit + (module * 8), LOW);
+            pressed &= pressed - 1;
         }
     }
 }
@@ -133,19 +212,15 @@ void MFInputShifter::triggerOnRelease()
     if (!_initialized || !_inputHandler)
         return;
 
-    uint8_t state;
-
     poll(DONT_TRIGGER);
 
-    // Trigger all the released buttons
-    for (int module = 0; module < _moduleCount; module++) {
-        state = _lastState[module];
-        for (uint8_t i = 0; i < 8; i++) {
-            // Only trigger if the button is in the off position
-            if (state & 1) {
-                trigger(i + (module * 8), HIGH);
-            }
-            state = state >> 1;
+    // Trigger all the released buttons, these are the bits in the on position
+    for (uint8_t module = 0; module < _moduleCount; module++) {
+        uint8_t released = _lastState[module];
+        while (released) {
+            uint8_t bit = __builtin_ctz(released);
+            trigger(bit + (module * 8), HIGH);
+            released &= released - 1;
         }
     }
 }
@@ -7,6 +7,14 @@
 #pragma once
 
 #include <Arduino.h>
+#if defined(ARDUINO_ARCH_RP2040)
+#include <hardware/spi.h>
+#endif
+
+// Clock rate if the shift registers are read by the hardware SPI
+#ifndef MF_INPUTSHIFTER_SPI_CLOCK
+    #define MF_INPUTSHIFTER_SPI_CLOCK 4000000
+#endif
 
 extern "C" {
 typedef void (*inputShifterEvent)(byte, uint8_t, const char *);
@@ -38,11 +46,18 @@ private:
     uint8_t     _dataPin;     // SDO (data) pin
     uint8_t     _moduleCount; // Number of 8 bit modules in series.
     bool        _initialized = false;
+    bool        _useSPI      = false; // clock and data pin are connected to the hardware SPI
     uint8_t    *_lastState;
+#if defined(ARDUINO_ARCH_RP2040)
+    spi_inst_t *_spi;
+#endif
 
-    void poll(uint8_t doTrigger);
-    void detectChanges(uint8_t lastState, uint8_t currentState, uint8_t module);
-    void trigger(uint8_t pin, bool state);
+    bool    attachSPI();
+    void    detachSPI();
+    uint8_t readByte();
+    void    poll(uint8_t doTrigger);
+    void    detectChanges(uint32_t lastState, uint32_t currentState, uint8_t firstPin);
+    void    trigger(uint8_t pin, bool state);
 
     static inputShifterEvent _inputHandler;
 };
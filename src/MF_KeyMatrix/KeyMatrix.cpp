@@ -0,0 +1,89 @@
+//
+// KeyMatrix.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "mobiflight.h"
+#include "MFKeyMatrix.h"
+#include "KeyMatrix.h"
+#include "IOCore.h"
+
+#if MF_KEYMATRIX_SUPPORT == 1
+namespace KeyMatrix
+{
+    MFKeyMatrix *keyMatrix;
+    uint8_t      keyMatrixRegistered = 0;
+    uint8_t      maxKeyMatrix        = 0;
+
+    // like kButtonChange, but the key is identified by its index (row * columns + column)
+    void handlerOnKeyMatrix(uint8_t eventId, uint8_t key, const char *name)
+    {
+        if (!getBoardReady())
+            return;
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::pushEvent(IOCore::EVENT_PIN_VALUE, kKeyMatrixChange, name, key, eventId);
+#else
+        cmdMessenger.sendCmdStart(kKeyMatrixChange);
+        cmdMessenger.sendCmdArg(name);
+        cmdMessenger.sendCmdArg(key);
+        cmdMessenger.sendCmdArg(eventId);
+        cmdMessenger.sendCmdEnd();
+#endif
+    };
+
+    bool setupArray(uint16_t count)
+    {
+        if (!FitInMemory(sizeof(MFKeyMatrix) * count))
+            return false;
+        keyMatrix    = new (allocateMemory(sizeof(MFKeyMatrix) * count)) MFKeyMatrix;
+        maxKeyMatrix = count;
+        return true;
+    }
+
+    void Add(uint8_t rows, uint8_t cols, const uint8_t *pins, char const *name)
+    {
+        if (keyMatrixRegistered == maxKeyMatrix)
+            return;
+
+        keyMatrix[keyMatrixRegistered] = MFKeyMatrix();
+        if (!keyMatrix[keyMatrixRegistered].attach(rows, cols, pins, name)) {
+            cmdMessenger.sendCmd(kStatus, F("KeyMatrix has too many rows or columns"));
+            return;
+        }
+        MFKeyMatrix::attachHandler(handlerOnKeyMatrix);
+        keyMatrixRegistered++;
+#ifdef DEBUG2CMDMESSENGER
+        cmdMessenger.sendCmd(kDebug, F("Added key matrix"));
+#endif
+    }
+
+    void Clear()
+    {
+        for (uint8_t i = 0; i < keyMatrixRegistered; i++) {
+            keyMatrix[i].detach();
+        }
+        keyMatrixRegistered = 0;
+        maxKeyMatrix        = 0;
+#ifdef DEBUG2CMDMESSENGER
+        cmdMessenger.sendCmd(kDebug, F("Cleared key matrices"));
+#endif
+    }
+
+    void read()
+    {
+        for (uint8_t i = 0; i < keyMatrixRegistered; i++) {
+            keyMatrix[i].update();
+        }
+    }
+
+    void OnTrigger()
+    {
+        for (uint8_t i = 0; i < keyMatrixRegistered; i++) {
+            keyMatrix[i].retrigger();
+        }
+    }
+} // namespace KeyMatrix
+#endif
+
+// KeyMatrix.cpp
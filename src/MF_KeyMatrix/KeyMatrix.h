@@ -0,0 +1,20 @@
+//
+// KeyMatrix.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <stdint.h>
+
+namespace KeyMatrix
+{
+    bool setupArray(uint16_t count);
+    void Add(uint8_t rows, uint8_t cols, const uint8_t *pins, char const *name = "KeyMatrix");
+    void Clear();
+    void read();
+    void OnTrigger();
+}
+
+// KeyMatrix.h
@@ -0,0 +1,190 @@
+//
+// MFKeyMatrix.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "MFKeyMatrix.h"
+
+keyMatrixEvent MFKeyMatrix::_handler = NULL;
+
+MFKeyMatrix::MFKeyMatrix()
+{
+    _initialized = false;
+}
+
+bool MFKeyMatrix::attach(uint8_t rows, uint8_t cols, const uint8_t *pins, const char *name)
+{
+    if (rows == 0 || rows > MF_KEYMATRIX_MAX_ROWS || cols == 0 || cols > MF_KEYMATRIX_MAX_COLS)
+        return false;
+
+    _rows = rows;
+    _cols = cols;
+    _name = name;
+    // rows are high impedance and driven low only while they are read
+    for (uint8_t r = 0; r < _rows; r++) {
+        _rowPin[r] = pins[r];
+        pinMode(_rowPin[r], INPUT);
+        digitalWrite(_rowPin[r], LOW);
+#if defined(ARDUINO_ARCH_AVR)
+        _rowDdr[r]  = portModeRegister(digitalPinToPort(_rowPin[r]));
+        _rowMask[r] = digitalPinToBitMask(_rowPin[r]);
+#elif defined(ARDUINO_ARCH_RP2040)
+        gpio_put(_rowPin[r], 0);
+#endif
+    }
+    for (uint8_t c = 0; c < _cols; c++) {
+        _colPin[c] = pins[_rows + c];
+        pinMode(_colPin[c], INPUT_PULLUP);
+#if defined(ARDUINO_ARCH_AVR)
+        _colPort[c] = portInputRegister(digitalPinToPort(_colPin[c]));
+        _colMask[c] = digitalPinToBitMask(_colPin[c]);
+#endif
+    }
+
+    // Initialize all keys with current status
+    scan(_state);
+    if (hasGhostKeys(_state))
+        memset(_state, 0, sizeof(_state));
+    memcpy(_lastScan, _state, sizeof(_lastScan));
+    _initialized = true;
+    return true;
+}
+
+void MFKeyMatrix::detach()
+{
+    if (!_initialized)
+        return;
+    for (uint8_t r = 0; r < _rows; r++)
+        pinMode(_rowPin[r], INPUT_PULLUP);
+    _initialized = false;
+}
+
+// Returns the pressed keys of the selected row, bit n is column n
+uint8_t MFKeyMatrix::readCols()
+{
+    uint8_t keys = 0;
+#if defined(ARDUINO_ARCH_AVR)
+    for (uint8_t c = 0; c < _cols; c++) {
+        if (!(*_colPort[c] & _colMask[c]))
+            keys |= (1 << c);
+    }
+#elif defined(ARDUINO_ARCH_RP2040)
+    uint32_t pins = gpio_get_all();
+    for (uint8_t c = 0; c < _cols; c++) {
+        if (!(pins & (1UL << _colPin[c])))
+            keys |= (1 << c);
+    }
+#else
+    for (uint8_t c = 0; c < _cols; c++) {
+        if (!digitalRead(_colPin[c]))
+            keys |= (1 << c);
+    }
+#endif
+    return keys;
+}
+
+// Reads all rows, only the direction of the row pins is switched as their output value is always low
+void MFKeyMatrix::scan(uint8_t *keys)
+{
+    for (uint8_t r = 0; r < _rows; r++) {
+#if defined(ARDUINO_ARCH_AVR)
+        uint8_t oldSREG = SREG;
+        cli(); // the port might be shared with pins written from an ISR
+        *_rowDdr[r] |= _rowMask[r];
+        SREG = oldSREG;
+        delayMicroseconds(MF_KEYMATRIX_SETTLE_US);
+        keys[r] = readCols();
+        cli();
+        *_rowDdr[r] &= ~_rowMask[r];
+        SREG = oldSREG;
+#elif defined(ARDUINO_ARCH_RP2040)
+        gpio_set_dir(_rowPin[r], true);
+        delayMicroseconds(MF_KEYMATRIX_SETTLE_US);
+        keys[r] = readCols();
+        gpio_set_dir(_rowPin[r], false);
+#else
+        pinMode(_rowPin[r], OUTPUT);
+        digitalWrite(_rowPin[r], LOW);
+        delayMicroseconds(MF_KEYMATRIX_SETTLE_US);
+        keys[r] = readCols();
+        pinMode(_rowPin[r], INPUT);
+#endif
+    }
+}
+
+// Two rows sharing more than one pressed column form a rectangle, one of its keys might be a ghost
+bool MFKeyMatrix::hasGhostKeys(const uint8_t *keys)
+{
+    for (uint8_t r1 = 0; r1 < _rows; r1++) {
+        if (!(keys[r1] & (keys[r1] - 1)))
+            continue; // less than two keys pressed in this row
+        for (uint8_t r2 = r1 + 1; r2 < _rows; r2++) {
+            uint8_t common = keys[r1] & keys[r2];
+            if (common & (common - 1))
+                return true;
+        }
+    }
+    return false;
+}
+
+// Keys which have been read with the same value in this and the previous scan are debounced.
+// The bit operations process a complete row at once.
+void MFKeyMatrix::update()
+{
+    uint8_t keys[MF_KEYMATRIX_MAX_ROWS];
+
+    if (!_initialized)
+        return;
+    scan(keys);
+    if (hasGhostKeys(keys))
+        return;
+    for (uint8_t r = 0; r < _rows; r++) {
+        uint8_t stable  = ~(keys[r] ^ _lastScan[r]);
+        uint8_t changed = (keys[r] ^ _state[r]) & stable;
+        _lastScan[r]    = keys[r];
+        if (changed) {
+            detectChanges(r, _state[r], _state[r] ^ changed);
+            _state[r] ^= changed;
+        }
+    }
+}
+
+// Only the changed bits are visited, the lowest one is cleared after each trigger
+void MFKeyMatrix::detectChanges(uint8_t row, uint8_t lastState, uint8_t currentState)
+{
+    uint8_t diff = lastState ^ currentState;
+
+    while (diff) {
+        uint8_t c = __builtin_ctz(diff);
+        trigger(row * _cols + c, (currentState >> c) & 0x01);
+        diff &= diff - 1;
+    }
+}
+
+// Fires 'release' events for every released key, followed by 'press' events for every pressed key
+void MFKeyMatrix::retrigger()
+{
+    uint8_t allCols = (1 << _cols) - 1;
+
+    if (!_initialized)
+        return;
+    for (uint8_t r = 0; r < _rows; r++)
+        detectChanges(r, allCols, _state[r]);
+    for (uint8_t r = 0; r < _rows; r++)
+        detectChanges(r, 0x00, _state[r]);
+}
+
+void MFKeyMatrix::trigger(uint8_t key, bool pressed)
+{
+    if (_handler != NULL) {
+        (*_handler)(pressed ? keyMatrixOnPress : keyMatrixOnRelease, key, _name);
+    }
+}
+
+void MFKeyMatrix::attachHandler(keyMatrixEvent newHandler)
+{
+    _handler = newHandler;
+}
+
+// MFKeyMatrix.cpp
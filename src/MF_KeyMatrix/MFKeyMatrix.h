@@ -0,0 +1,75 @@
+//
+// MFKeyMatrix.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <Arduino.h>
+#if defined(ARDUINO_ARCH_RP2040)
+#include <hardware/gpio.h>
+#endif
+
+#define MF_KEYMATRIX_MAX_ROWS 8
+#define MF_KEYMATRIX_MAX_COLS 8
+
+// Time for the column lines to follow the selected row, the pull-ups have to charge the lines
+#ifndef MF_KEYMATRIX_SETTLE_US
+#define MF_KEYMATRIX_SETTLE_US 3
+#endif
+
+extern "C" {
+// callback functions
+typedef void (*keyMatrixEvent)(uint8_t, uint8_t, const char *);
+};
+
+enum {
+    keyMatrixOnPress,
+    keyMatrixOnRelease,
+};
+
+/* **********************************************************************************
+    Matrix of up to 8 x 8 keys. One row after the other is pulled low, all other
+    rows are high impedance, and the columns with internal pull-ups are read.
+    A key changes its state only if it has been read twice with the same value
+    (one scan interval apart). Without diodes, three pressed keys at the corners of
+    a rectangle let the fourth key appear pressed. Scans with such a pattern are
+    discarded, so no ghost key gets reported.
+********************************************************************************** */
+class MFKeyMatrix
+{
+public:
+    MFKeyMatrix();
+    static void attachHandler(keyMatrixEvent newHandler);
+    bool        attach(uint8_t rows, uint8_t cols, const uint8_t *pins, const char *name);
+    void        detach();
+    void        update();
+    void        retrigger();
+
+private:
+    static keyMatrixEvent _handler;
+
+    const char *_name;
+    uint8_t     _rows;
+    uint8_t     _cols;
+    uint8_t     _rowPin[MF_KEYMATRIX_MAX_ROWS];
+    uint8_t     _colPin[MF_KEYMATRIX_MAX_COLS];
+    uint8_t     _lastScan[MF_KEYMATRIX_MAX_ROWS]; // previous raw scan, bit n is column n, 1 = pressed
+    uint8_t     _state[MF_KEYMATRIX_MAX_ROWS];    // debounced state, 1 = pressed
+    bool        _initialized = false;
+#if defined(ARDUINO_ARCH_AVR)
+    volatile uint8_t *_rowDdr[MF_KEYMATRIX_MAX_ROWS]; // direction register and bit of the row pins
+    uint8_t           _rowMask[MF_KEYMATRIX_MAX_ROWS];
+    volatile uint8_t *_colPort[MF_KEYMATRIX_MAX_COLS]; // input register and bit of the column pins
+    uint8_t           _colMask[MF_KEYMATRIX_MAX_COLS];
+#endif
+
+    void    scan(uint8_t *keys);
+    uint8_t readCols();
+    bool    hasGhostKeys(const uint8_t *keys);
+    void    detectChanges(uint8_t row, uint8_t lastState, uint8_t currentState);
+    void    trigger(uint8_t key, bool pressed);
+};
+
+// MFKeyMatrix.h
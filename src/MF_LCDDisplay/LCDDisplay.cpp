@@ -7,6 +7,7 @@
 #include "mobiflight.h"
 #include "MFLCDDisplay.h"
 #include "LCDDisplay.h"
+#include "IOCore.h"
 
 namespace LCDDisplay
 {
@@ -28,7 +29,11 @@ namespace LCDDisplay
         if (lcd_12cRegistered == maxLCD_I2C)
             return;
         lcd_I2C[lcd_12cRegistered] = MFLCDDisplay();
-        lcd_I2C[lcd_12cRegistered].attach(address, cols, lines);
+        if (!lcd_I2C[lcd_12cRegistered].attach(address, cols, lines)) {
+            if (!GetMemoryTrial())
+                cmdMessenger.sendCmd(kStatus, F("LCD buffer does not fit into Memory"));
+            return;
+        }
         lcd_12cRegistered++;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Added lcdDisplay"));
@@ -41,6 +46,7 @@ namespace LCDDisplay
             lcd_I2C[i].detach();
         }
         lcd_12cRegistered = 0;
+        maxLCD_I2C        = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared lcdDisplays"));
 #endif
@@ -54,12 +60,29 @@ namespace LCDDisplay
         lcd_I2C[address].display(output);
     }
 
-    void PowerSave(bool state)
+    void update()
+    {
+        for (uint8_t i = 0; i < lcd_12cRegistered; ++i) {
+            lcd_I2C[i].update();
+        }
+    }
+
+    // accesses the hardware, with IO_ON_2ND_CORE it is executed on the 2nd core
+    void powerSave(uint8_t state, uint8_t = 0, uint8_t = 0, uint8_t = 0)
     {
         for (uint8_t i = 0; i < lcd_12cRegistered; ++i) {
             lcd_I2C[i].powerSavingMode(state);
         }
     }
+
+    void PowerSave(bool state)
+    {
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::call(1 << kTaskLcdDisplays, powerSave, state);
+#else
+        powerSave(state);
+#endif
+    }
 } // namespace
 
 // LCDDisplay.cpp
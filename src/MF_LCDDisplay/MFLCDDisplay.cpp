@@ -5,24 +5,110 @@
 //
 
 #include "MFLCDDisplay.h"
+#include "allocateMem.h"
 
 MFLCDDisplay::MFLCDDisplay()
 {
     _initialized = false;
 }
 
+// Only stores the new content, update() transmits the changed characters.
+// The bit of each character which differs from the stored content is toggled,
+// so it differs from its bit in _shown until update() has transmitted it.
 void MFLCDDisplay::display(const char *string)
 {
     if (!_initialized)
         return;
-    for (uint8_t line = 0; line != _lines; line++) {
-        _lcdDisplay.setCursor(0, line);
-        _lcdDisplay.writeString(&string[line * _cols], _cols);
+    uint8_t size   = _cols * _lines;
+    uint8_t toggle = 0;
+    uint8_t i;
+    for (i = 0; i < size && string[i]; i++) {
+        if (_frame[i] != string[i]) {
+            _frame[i] = string[i];
+            toggle |= 1 << (i & 7);
+        }
+        if ((i & 7) == 7) {
+            _toggleChanged(i >> 3, toggle);
+            toggle = 0;
+        }
     }
+    if (toggle)
+        _toggleChanged(i >> 3, toggle);
+    // display() and update() can run on different cores, so a counter
+    // written only here is used instead of a flag written by both
+    __atomic_store_n(&_frameGen, (uint8_t)(_frameGen + 1), __ATOMIC_RELEASE);
 }
 
-void MFLCDDisplay::attach(byte address, byte cols, byte lines)
+// Transmits the characters which differ from the display content. Consecutive changed characters
+// within a line are sent with one setCursor() and max. MF_LCD_CHARS_PER_UPDATE characters are sent
+// per call, the next call continues where the last one has stopped.
+// A new frame is started not before MF_LCD_REFRESH_MS after the last one. Content received
+// in between overwrites the pending content, so only the latest one gets transmitted.
+void MFLCDDisplay::update()
 {
+    if (!_initialized)
+        return;
+
+    if (!_rendering) {
+        uint8_t frameGen = __atomic_load_n(&_frameGen, __ATOMIC_ACQUIRE);
+        if (frameGen == _shownGen || millis() - _lastFrame < MF_LCD_REFRESH_MS)
+            return;
+        // content received while transmitting gets a new pass
+        _renderGen = frameGen;
+        _rendering = true;
+        _lastFrame = millis();
+    }
+
+    uint8_t size   = _cols * _lines;
+    uint8_t budget = MF_LCD_CHARS_PER_UPDATE;
+    uint8_t pos    = _renderPos;
+
+    for (uint8_t checked = 0; checked < size;) {
+        if (!_isPending(pos)) {
+            checked++;
+            if (++pos == size) pos = 0;
+            continue;
+        }
+        if (!budget) {
+            _renderPos = pos;
+            return;
+        }
+        uint8_t lineEnd = (pos / _cols + 1) * _cols;
+        uint8_t len     = 0;
+        while (pos + len < lineEnd && len < budget && _isPending(pos + len)) {
+            _markShown(pos + len);
+            len++;
+        }
+        // the characters are read after their bits, a character changed in between gets sent again
+        _lcdDisplay.setCursor(pos % _cols, pos / _cols);
+        _lcdDisplay.writeString(&_frame[pos], len);
+        budget -= len;
+        checked += len;
+        pos += len;
+        if (pos == size) pos = 0;
+    }
+    // a complete pass without differences
+    _renderPos = pos;
+    _shownGen  = _renderGen;
+    _rendering = false;
+}
+
+bool MFLCDDisplay::attach(byte address, byte cols, byte lines)
+{
+    uint8_t bitmapSize = (cols * lines + 7) / 8;
+    if (!FitInMemory(cols * lines + 2 * bitmapSize))
+        return false;
+    _frame   = (char *)allocateMemory(cols * lines + 2 * bitmapSize);
+    _changed = (uint8_t *)&_frame[cols * lines];
+    _shown   = &_changed[bitmapSize];
+    // Nothing is pending, so the test message stays until the first content is received
+    memset(_frame, 0, cols * lines + 2 * bitmapSize);
+    _frameGen  = 0;
+    _shownGen  = 0;
+    _rendering = false;
+    _renderPos = 0;
+    _lastFrame = 0;
+
     _address     = address;
     _cols        = cols;
     _lines       = lines;
@@ -31,6 +117,7 @@ void MFLCDDisplay::attach(byte address, byte cols, byte lines)
     _lcdDisplay.backlight();
     Wire.setClock(400000);
     test();
+    return true;
 }
 
 void MFLCDDisplay::detach()
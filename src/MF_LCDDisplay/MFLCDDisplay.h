@@ -9,24 +9,53 @@
 #include <Arduino.h>
 #include <LiquidCrystal_I2C.h>
 
+// Max. number of characters transmitted to one display per update() call,
+// limits the time loop() is blocked by the I2C transfer
+#ifndef MF_LCD_CHARS_PER_UPDATE
+#define MF_LCD_CHARS_PER_UPDATE 8
+#endif
+// Min. time between transmitting two frames, content received in between is combined
+#ifndef MF_LCD_REFRESH_MS
+#define MF_LCD_REFRESH_MS 50
+#endif
+
 class MFLCDDisplay
 {
 public:
     MFLCDDisplay();
     void display(const char *string);
-    void attach(byte address, byte cols, byte lines);
+    bool attach(byte address, byte cols, byte lines);
     void detach();
     void test();
+    void update();
     void powerSavingMode(bool state);
 
 private:
     LiquidCrystal_I2C _lcdDisplay;
     bool              _initialized;
+    volatile uint8_t  _frameGen;  // incremented for each new content, only written by display()
+    uint8_t           _shownGen;  // _frameGen of the last completely transmitted frame
+    uint8_t           _renderGen; // _frameGen of the frame being transmitted
+    bool              _rendering; // a frame is being transmitted
+    uint32_t          _lastFrame; // start of the last transmitted frame
     byte              _address;
     byte              _cols;
     byte              _lines;
+    uint8_t           _renderPos; // position where the last update() has stopped
+    char             *_frame;     // content to be displayed
+    uint8_t          *_changed;   // bit per character, toggled by display() if the character has changed
+    uint8_t          *_shown;     // bit per character, copied from _changed by update() when it is transmitted
 
     void              _printCentered(const char *str, uint8_t line);
+    // the characters must be visible to update() before their bits
+    void              _toggleChanged(uint8_t index, uint8_t toggle) { __atomic_store_n(&_changed[index], (uint8_t)(_changed[index] ^ toggle), __ATOMIC_RELEASE); }
+    uint8_t           _getChanged(uint8_t index) { return __atomic_load_n(&_changed[index], __ATOMIC_ACQUIRE); }
+    bool              _isPending(uint8_t pos) { return ((_getChanged(pos >> 3) ^ _shown[pos >> 3]) >> (pos & 7)) & 1; }
+    void              _markShown(uint8_t pos)
+    {
+        uint8_t mask     = 1 << (pos & 7);
+        _shown[pos >> 3] = (_shown[pos >> 3] & ~mask) | (_getChanged(pos >> 3) & mask);
+    }
 };
 
-// MFLCDDisplay.h
\ No newline at end of file
+// MFLCDDisplay.h
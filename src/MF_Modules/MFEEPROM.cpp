@@ -32,8 +32,29 @@ uint8_t MFEEPROM::read_byte(uint16_t adr)
 bool MFEEPROM::write_byte(uint16_t adr, const uint8_t data)
 {
     if (adr >= _eepromLength) return false;
-    EEPROM.write(adr, data);
+    write_bytes(adr, &data, 1);
     return true;
 }
 
+void MFEEPROM::read_bytes(uint16_t adr, uint8_t *data, uint16_t len)
+{
+#if defined(ARDUINO_ARCH_AVR)
+    eeprom_read_block(data, (const void *)(uintptr_t)adr, len);
+#else
+    memcpy(data, EEPROM.getConstDataPtr() + adr, len);
+#endif
+}
+
+// Only bytes which differ are written. This saves erase cycles on the AVR
+// and avoids committing an unchanged emulated EEPROM on the RP2040.
+void MFEEPROM::write_bytes(uint16_t adr, const uint8_t *data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        if (EEPROM.read(adr + i) == data[i])
+            continue;
+        EEPROM.write(adr + i, data[i]);
+        _dirty = true;
+    }
+}
+
 // MFEEPROM.cpp
\ No newline at end of file
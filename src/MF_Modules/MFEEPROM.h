@@ -12,6 +12,10 @@ class MFEEPROM
 {
 private:
     uint16_t _eepromLength = 0;
+    bool     _dirty        = false; // content has changed since the last commit
+
+    void read_bytes(uint16_t adr, uint8_t *data, uint16_t len);
+    void write_bytes(uint16_t adr, const uint8_t *data, uint16_t len);
 
 public:
     MFEEPROM();
@@ -19,10 +23,14 @@ public:
     uint16_t get_length(void);
     uint8_t read_byte(uint16_t adr);
     bool write_byte(uint16_t adr, const uint8_t data);
+    // On the RP2040 all writes are going to a RAM copy and a commit flashes
+    // the complete emulated EEPROM, so it is only done if something has changed
     void commit() {
 #if !defined(ARDUINO_ARCH_AVR)
-        EEPROM.commit();
+        if (_dirty)
+            EEPROM.commit();
 #endif
+        _dirty = false;
     }
 
     template <typename T>
@@ -37,10 +45,7 @@ public:
     bool read_block(uint16_t adr, T &t, uint16_t len)
     {
         if (adr + len > _eepromLength) return false;
-        uint8_t *ptr = (uint8_t*) &t;
-        for (uint16_t i = 0; i < len; i++) {
-            *ptr++ = EEPROM.read(adr + i);
-        }
+        read_bytes(adr, (uint8_t *)&t, len);
         return true;
     }
 
@@ -48,7 +53,7 @@ public:
     const bool write_block(uint16_t adr, const T &t)
     {
         if (adr + sizeof(T) > _eepromLength) return false;
-        EEPROM.put(adr, t);
+        write_bytes(adr, (const uint8_t *)&t, sizeof(T));
         return true;
     }
 
@@ -56,9 +61,7 @@ public:
     const bool write_block(uint16_t adr, const T &t, uint16_t len)
     {
         if (adr + len > _eepromLength) return false;
-        for (uint16_t i = 0; i < len; i++) {
-            EEPROM.put(adr + i, t[i]);
-        }
+        write_bytes(adr, (const uint8_t *)&t[0], len);
         return true;
     }
 };
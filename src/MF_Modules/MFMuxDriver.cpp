@@ -7,6 +7,8 @@
 #include "mobiflight.h"
 #include "MFMuxDriver.h"
 
+uint8_t MFMuxDriver::_selPinsUsed[(NUM_DIGITAL_PINS + 7) / 8] = {0};
+
 MFMuxDriver::MFMuxDriver(void)
 {
     _flags = 0x00;
@@ -25,11 +27,30 @@ void MFMuxDriver::
     _selPin[3] = Sel3Pin;
     _flags     = 0x00;
 
-    for (uint8_t i = 0; i < 4; i++)
+    for (uint8_t i = 0; i < 4; i++) {
         pinMode(_selPin[i], OUTPUT);
-    bitSet(_flags, MUX_INITED);
+        digitalWrite(_selPin[i], LOW);
+        if (_selPin[i] < NUM_DIGITAL_PINS)
+            _selPinsUsed[_selPin[i] >> 3] |= 1 << (_selPin[i] & 7);
+    }
+    _channel = 0;
 
-    setChannel(0);
+#if defined(ARDUINO_ARCH_AVR)
+    // If all selector pins are on the same port, they are written at once
+    _selPort    = portOutputRegister(digitalPinToPort(_selPin[0]));
+    _selMaskAll = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        _selMask[i] = digitalPinToBitMask(_selPin[i]);
+        _selMaskAll |= _selMask[i];
+        if (digitalPinToPort(_selPin[i]) != digitalPinToPort(_selPin[0]))
+            _selPort = NULL;
+    }
+#elif defined(ARDUINO_ARCH_RP2040)
+    _selMaskAll = 0;
+    for (uint8_t i = 0; i < 4; i++)
+        _selMaskAll |= 1UL << _selPin[i];
+#endif
+    bitSet(_flags, MUX_INITED);
 }
 
 void MFMuxDriver::detach()
@@ -37,29 +58,76 @@ void MFMuxDriver::detach()
     for (uint8_t i = 0; i < 4; i++) {
         if (_selPin[i] == 0xFF) continue;
         pinMode(_selPin[i], INPUT_PULLUP);
+        if (_selPin[i] < NUM_DIGITAL_PINS)
+            _selPinsUsed[_selPin[i] >> 3] &= ~(1 << (_selPin[i] & 7));
         _selPin[i] = 0xFF;
     }
     bitClear(_flags, MUX_INITED);
 }
 
+// Checks if the driver is attached to the given selector pins
+bool MFMuxDriver::hasSelPins(uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin)
+{
+    return bitRead(_flags, MUX_INITED) && _selPin[0] == Sel0Pin && _selPin[1] == Sel1Pin && _selPin[2] == Sel2Pin && _selPin[3] == Sel3Pin;
+}
+
+// Checks if one of the selector pins is already used by an attached driver
+bool MFMuxDriver::selPinsUsed(uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin)
+{
+    uint8_t pins[4] = {Sel0Pin, Sel1Pin, Sel2Pin, Sel3Pin};
+    for (uint8_t i = 0; i < 4; i++) {
+        if (pins[i] < NUM_DIGITAL_PINS && (_selPinsUsed[pins[i] >> 3] & (1 << (pins[i] & 7))))
+            return true;
+    }
+    return false;
+}
+
 // Sets the driver lines to select the specified channel
 void MFMuxDriver::setChannel(uint8_t value)
 {
     if (!bitRead(_flags, MUX_INITED)) return;
     if (value > 15) return;
 
-    // Ideally, setChannel() should change all pins atomically (at the same time):
-    // since it doesn't, be advised that there will be signal glitches because
+    // Ideally, setChannel() should change all pins atomically (at the same time).
+    // This is done if all selector pins are on the same port (AVR) or always on the RP2040.
+    // Otherwise be advised that there will be signal glitches because
     // the actual code - which is not latched - spans several values as the single bits are changed.
     // This should not be an issue, because e.g. in an input mux the output is only read at the end,
-    // once the code is stable.
+    // once the code is stable. Sweeping the channels in Gray code order (see grayChannel())
+    // changes only one selector pin per step and avoids these glitches.
     // (Please note that output value settling is a completely different effect.)
     // However, this effect might have to be taken into account.
 
+    uint8_t changed = _channel ^ value;
+    if (!changed) return;
     _channel = value;
+
+#if defined(ARDUINO_ARCH_AVR)
+    if (_selPort) {
+        uint8_t bits = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            if (value & (1 << i)) bits |= _selMask[i];
+        }
+        uint8_t oldSREG = SREG;
+        cli(); // the port might be shared with pins written from an ISR
+        *_selPort = (*_selPort & ~_selMaskAll) | bits;
+        SREG      = oldSREG;
+        return;
+    }
+#elif defined(ARDUINO_ARCH_RP2040)
+    uint32_t bits = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (value & (1 << i)) bits |= 1UL << _selPin[i];
+    }
+    gpio_put_masked(_selMaskAll, bits);
+    return;
+#endif
+
+    // only the selector pins which differ from the previous channel are written
     for (uint8_t i = 0; i < 4; i++) {
-        digitalWrite(_selPin[i], (value & 0x01));
+        if (changed & 0x01) digitalWrite(_selPin[i], (value & 0x01));
         value >>= 1;
+        changed >>= 1;
     }
 }
 
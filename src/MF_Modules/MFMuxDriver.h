@@ -7,6 +7,9 @@
 #pragma once
 
 #include <Arduino.h>
+#if defined(ARDUINO_ARCH_RP2040)
+#include <hardware/gpio.h>
+#endif
 
 extern "C" {
 typedef void (*MuxDigInEvent)(byte, uint8_t, const char *);
@@ -18,6 +21,9 @@ public:
     MFMuxDriver(void);
     void    attach(uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin);
     void    detach();
+    bool    hasSelPins(uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin);
+    // Each driver caches its channel, so a selector pin must not be written by two drivers
+    static bool selPinsUsed(uint8_t Sel0Pin, uint8_t Sel1Pin, uint8_t Sel2Pin, uint8_t Sel3Pin);
 
     // void setChannelOpt(uint8_t mode);
     void    setChannel(uint8_t value);
@@ -26,14 +32,26 @@ public:
     void    saveChannel(void); // Not reentrant - one level only
     void    restoreChannel(void);
 
+    // Returns the channel for each step of a sweep in Gray code order
+    static uint8_t grayChannel(uint8_t step) { return step ^ (step >> 1); }
+
 private:
     enum { MUX_INITED = 0,
     };
 
+    static uint8_t _selPinsUsed[(NUM_DIGITAL_PINS + 7) / 8]; // selector pins of all attached drivers
+
     uint8_t _selPin[4]; // Selector pins; 0 is LSb
     uint8_t _flags;
     uint8_t _channel;
     uint8_t _savedChannel;
+#if defined(ARDUINO_ARCH_AVR)
+    volatile uint8_t *_selPort;   // output register if all selector pins are on the same port, otherwise NULL
+    uint8_t           _selMask[4]; // port bit of each selector pin
+    uint8_t           _selMaskAll;
+#elif defined(ARDUINO_ARCH_RP2040)
+    uint32_t _selMaskAll; // GPIO bits of all selector pins
+#endif
 };
 
 // MFMuxDriver.h
@@ -0,0 +1,127 @@
+//
+// MFScheduler.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "MFScheduler.h"
+
+MFScheduler::MFScheduler()
+{
+    _taskCount   = 0;
+    _pausedTasks = 0;
+}
+
+bool MFScheduler::add(uint8_t id, taskFunction fun, uint16_t period, uint16_t phase, uint8_t priority)
+{
+    if (_taskCount == MF_SCHEDULER_MAX_TASKS)
+        return false;
+    task *t     = &_tasks[_taskCount++];
+    t->fun      = fun;
+    t->id       = id;
+    t->period   = period;
+    t->phase    = phase;
+    t->priority = priority;
+    t->deadline = (uint16_t)millis() + phase;
+    t->overruns = 0;
+    t->maxLate  = 0;
+    sort();
+    return true;
+}
+
+bool MFScheduler::setTiming(uint8_t id, uint16_t period, uint16_t phase, uint8_t priority)
+{
+    // deadlines are compared on 16 bit, so they must be less than half the range ahead
+    if (period >= 0x8000 || phase >= 0x8000)
+        return false;
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (_tasks[i].id != id)
+            continue;
+        _tasks[i].period   = period;
+        _tasks[i].phase    = phase;
+        _tasks[i].priority = priority;
+        _tasks[i].deadline = (uint16_t)millis() + phase;
+        sort();
+        return true;
+    }
+    return false;
+}
+
+// Starts all tasks again with their phase, e.g. after the scheduler was not running for a while
+void MFScheduler::restart()
+{
+    uint16_t now = millis();
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        _tasks[i].deadline = now + _tasks[i].phase;
+    }
+}
+
+// Runs all due tasks in order of their priority. The next deadline is calculated
+// from the previous one and not from the time the task has finished, so the
+// intervals do not drift by the execution time of the tasks.
+void MFScheduler::run()
+{
+    uint16_t now = millis();
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        task    *t    = &_tasks[i];
+        uint16_t late = now - t->deadline;
+        // a paused task is due as soon as it gets resumed
+        if (_pausedTasks & (1 << t->id)) {
+            t->deadline = now;
+            continue;
+        }
+        // deadline not reached yet, the difference has wrapped around
+        if (late >= 0x8000)
+            continue;
+        t->fun();
+        if (t->period == 0) {
+            // runs every time, but the deadline must follow, otherwise the task
+            // would not be due anymore when the difference wraps around after 32.768s
+            t->deadline = now;
+            continue;
+        }
+        if (late > t->maxLate)
+            t->maxLate = late;
+        if (late >= t->period) {
+            // one or more periods have been missed, do not try to catch up
+            t->overruns++;
+            t->deadline = now + t->period;
+        } else {
+            t->deadline += t->period;
+        }
+    }
+}
+
+bool MFScheduler::getStats(uint8_t index, uint8_t *id, uint16_t *overruns, uint16_t *maxLate)
+{
+    if (index >= _taskCount)
+        return false;
+    *id       = _tasks[index].id;
+    *overruns = _tasks[index].overruns;
+    *maxLate  = _tasks[index].maxLate;
+    return true;
+}
+
+void MFScheduler::resetStats()
+{
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        _tasks[i].overruns = 0;
+        _tasks[i].maxLate  = 0;
+    }
+}
+
+// Insertion sort by priority, tasks with the same priority keep their order
+void MFScheduler::sort()
+{
+    for (uint8_t i = 1; i < _taskCount; i++) {
+        task    t = _tasks[i];
+        uint8_t j = i;
+        while (j > 0 && _tasks[j - 1].priority > t.priority) {
+            _tasks[j] = _tasks[j - 1];
+            j--;
+        }
+        _tasks[j] = t;
+    }
+}
+
+// MFScheduler.cpp
@@ -0,0 +1,49 @@
+//
+// MFScheduler.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef MF_SCHEDULER_MAX_TASKS
+#define MF_SCHEDULER_MAX_TASKS 15 // all tasks of mobiflight.cpp
+#endif
+
+typedef void (*taskFunction)();
+
+class MFScheduler
+{
+public:
+    MFScheduler();
+    bool    add(uint8_t id, taskFunction fun, uint16_t period, uint16_t phase, uint8_t priority);
+    bool    setTiming(uint8_t id, uint16_t period, uint16_t phase, uint8_t priority);
+    void    restart();
+    void    run();
+    void    setPaused(uint16_t tasks) { _pausedTasks = tasks; }
+    uint8_t getTaskCount() { return _taskCount; }
+    bool    getStats(uint8_t index, uint8_t *id, uint16_t *overruns, uint16_t *maxLate);
+    void    resetStats();
+
+private:
+    struct task {
+        taskFunction fun;
+        uint16_t     deadline; // low word of millis() at which the task is due next
+        uint16_t     period;   // in ms, 0 = run in every loop
+        uint16_t     phase;    // delay of the first run after restart()
+        uint16_t     overruns; // number of periods which have been missed completely
+        uint16_t     maxLate;  // max. delay in ms after the deadline
+        uint8_t      priority; // 0 = highest, lower values run first if several tasks are due
+        uint8_t      id;
+    };
+
+    task     _tasks[MF_SCHEDULER_MAX_TASKS];
+    uint8_t  _taskCount;
+    uint16_t _pausedTasks; // bit mask of task IDs which are not run
+
+    void sort();
+};
+
+// MFScheduler.h
@@ -0,0 +1,43 @@
+//
+// MFSpiBlock.cpp
+//
+// (C) MobiFlight Project 2022
+//
+
+#include "MFSpiBlock.h"
+
+#if defined(ARDUINO_ARCH_RP2040)
+uint8_t MFSpiBlock::_count[2] = {0, 0};
+uint8_t MFSpiBlock::_user[2]  = {0, 0};
+
+// Returns false if the block is used by the other device type on the other core,
+// the device has to bit-bang its pins then
+bool MFSpiBlock::claim(spi_inst_t *spi, uint8_t user, uint32_t baudrate)
+{
+    uint8_t block = (spi == spi1) ? 1 : 0;
+#if defined(IO_ON_2ND_CORE)
+    if (_count[block] && _user[block] != user)
+        return false;
+#endif
+    if (_count[block] == 0)
+        spi_init(spi, baudrate);
+    _count[block]++;
+    _user[block] = user;
+    return true;
+}
+
+// Returns true if the block is disabled, otherwise it is still used by other devices
+// which might share the clock pin
+bool MFSpiBlock::release(spi_inst_t *spi)
+{
+    uint8_t block = (spi == spi1) ? 1 : 0;
+    if (_count[block] == 0)
+        return true;
+    if (--_count[block])
+        return false;
+    spi_deinit(spi);
+    return true;
+}
+#endif
+
+// MFSpiBlock.cpp
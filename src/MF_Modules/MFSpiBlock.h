@@ -0,0 +1,37 @@
+//
+// MFSpiBlock.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <Arduino.h>
+#if defined(ARDUINO_ARCH_RP2040)
+#include <hardware/spi.h>
+
+/* **********************************************************************************
+    The output and the input shifters can use the same SPI block of the RP2040.
+    The block is initialized by the first device and disabled when the last one
+    is detached, so detaching one device type does not stop the other one.
+    With IO_ON_2ND_CORE the input shifters are read by the 2nd core, so a block
+    is never shared by both device types then.
+********************************************************************************** */
+class MFSpiBlock
+{
+public:
+    enum {
+        USER_OUTPUT_SHIFTER,
+        USER_INPUT_SHIFTER
+    };
+
+    static bool claim(spi_inst_t *spi, uint8_t user, uint32_t baudrate);
+    static bool release(spi_inst_t *spi);
+
+private:
+    static uint8_t _count[2]; // number of devices using the block
+    static uint8_t _user[2];  // device type using the block
+};
+#endif
+
+// MFSpiBlock.h
@@ -0,0 +1,57 @@
+//
+// MFSpscQueue.h
+//
+// (C) MobiFlight Project 2022
+//
+
+#pragma once
+
+#include <Arduino.h>
+
+// Lock-free ring buffer for exactly one producer and one consumer, e.g. one core
+// writing and the other core reading. Each index is only written by one side,
+// so no locking is required. SIZE must be a power of 2, one entry is kept free.
+template <typename T, uint16_t SIZE>
+class MFSpscQueue
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of 2");
+
+public:
+    MFSpscQueue()
+        : _head(0), _tail(0) {}
+
+    // called by the producer only
+    bool push(const T &item)
+    {
+        uint16_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+        uint16_t next = (head + 1) & (SIZE - 1);
+        if (next == __atomic_load_n(&_tail, __ATOMIC_ACQUIRE))
+            return false;
+        _buffer[head] = item;
+        __atomic_store_n(&_head, next, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // called by the consumer only
+    bool pop(T *item)
+    {
+        uint16_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+        if (tail == __atomic_load_n(&_head, __ATOMIC_ACQUIRE))
+            return false;
+        *item = _buffer[tail];
+        __atomic_store_n(&_tail, (uint16_t)((tail + 1) & (SIZE - 1)), __ATOMIC_RELEASE);
+        return true;
+    }
+
+    bool empty()
+    {
+        return __atomic_load_n(&_tail, __ATOMIC_ACQUIRE) == __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+    }
+
+private:
+    T        _buffer[SIZE];
+    uint16_t _head; // next entry to write, only changed by the producer
+    uint16_t _tail; // next entry to read, only changed by the consumer
+};
+
+// MFSpscQueue.h
@@ -5,6 +5,11 @@
 //
 
 #include "MFOutput.h"
+#if defined(ARDUINO_ARCH_RP2040)
+#include "hardware/pwm.h"
+
+uint8_t MFOutput::_pwmSlicesUsed = 0;
+#endif
 
 MFOutput::MFOutput()
 {
@@ -16,6 +21,7 @@ void MFOutput::attach(uint8_t pin)
     _pin   = pin;
 #if defined(ARDUINO_ARCH_RP2040)
     pinMode(_pin, OUTPUT_12MA);
+    _pwmSlicesUsed |= 1 << pwm_gpio_to_slice_num(_pin);
 #else
     pinMode(_pin, OUTPUT);
 #endif
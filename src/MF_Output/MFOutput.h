@@ -22,10 +22,19 @@ public:
     void attach(uint8_t pin);
     void set(uint8_t value);
     void powerSavingMode(bool state);
+#if defined(ARDUINO_ARCH_RP2040)
+    // analogWrite() sets the frequency and range of the whole PWM slice of a pin,
+    // other devices must not change the timing of these slices
+    static bool isPwmSliceUsed(uint8_t slice) { return _pwmSlicesUsed & (1 << slice); }
+    static void releasePwmSlices() { _pwmSlicesUsed = 0; }
+#endif
 
 private:
     uint8_t _pin;
     uint8_t _value;
+#if defined(ARDUINO_ARCH_RP2040)
+    static uint8_t _pwmSlicesUsed; // one bit per PWM slice with an output pin
+#endif
 };
 
 // MFOutput.h
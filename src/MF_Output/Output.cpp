@@ -38,6 +38,10 @@ namespace Output
     void Clear()
     {
         outputsRegistered = 0;
+        maxOutputs        = 0;
+#if defined(ARDUINO_ARCH_RP2040)
+        MFOutput::releasePwmSlices();
+#endif
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared outputs"));
 #endif
@@ -6,6 +6,12 @@
 
 #include "MFOutputShifter.h"
 #include "allocateMem.h"
+#if defined(ARDUINO_ARCH_AVR)
+#include <SPI.h>
+#include "config.h"
+#elif defined(ARDUINO_ARCH_RP2040)
+#include "MFSpiBlock.h"
+#endif
 
 MFOutputShifter::MFOutputShifter()
 {
@@ -19,14 +25,22 @@ void MFOutputShifter::setPin(uint8_t pin, uint8_t value, uint8_t refresh)
     uint8_t idx = (pin & 0xF8) >> 3;
     uint8_t msk = (0x01 << (pin & 0x07));
 
+    if (idx >= _moduleCount) return;
+
+    uint8_t newState = _lastState[idx];
     if (value != MF_LOW) {
-        _lastState[idx] |= msk;
+        newState |= msk;
     } else {
-        _lastState[idx] &= ~msk;
+        newState &= ~msk;
+    }
+    if (newState != _lastState[idx]) {
+        _lastState[idx] = newState;
+        _dirty          = true;
     }
     if (refresh) update();
 }
 
+// Sets the pins, the registers are shifted out with the next flush()
 void MFOutputShifter::setPins(char *pins, uint8_t value)
 {
     if (!_initialized) return;
@@ -37,7 +51,31 @@ void MFOutputShifter::setPins(char *pins, uint8_t value)
         setPin(num, value, 0);
         pinTokens = strtok(0, "|");
     }
-    update();
+}
+
+// Sets up to 32 pins starting with the first pin of 'module'. For each bit set in 'mask'
+// the pin is set according the bit in 'values'. Registers are shifted out with the next flush()
+void MFOutputShifter::setMask(uint8_t module, uint32_t mask, uint32_t values)
+{
+    if (!_initialized) return;
+
+    if (MF_LOW != LOW) values = ~values;
+
+    for (uint8_t i = module; i < _moduleCount && mask; i++) {
+        uint8_t newState = (_lastState[i] & ~(uint8_t)mask) | ((uint8_t)values & (uint8_t)mask);
+        if (newState != _lastState[i]) {
+            _lastState[i] = newState;
+            _dirty        = true;
+        }
+        mask >>= 8;
+        values >>= 8;
+    }
+}
+
+// Shifts out the registers only if a pin has changed since the last update
+void MFOutputShifter::flush()
+{
+    if (_initialized && _dirty) update();
 }
 
 bool MFOutputShifter::attach(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin, uint8_t moduleCount)
@@ -51,6 +89,7 @@ bool MFOutputShifter::attach(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin
     pinMode(_latchPin, OUTPUT);
     pinMode(_clockPin, OUTPUT);
     pinMode(_dataPin, OUTPUT);
+    _useSPI = attachSPI();
 
     if (!FitInMemory(sizeof(uint8_t) * _moduleCount))
         return false;
@@ -64,9 +103,59 @@ bool MFOutputShifter::attach(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin
 
 void MFOutputShifter::detach()
 {
+    if (_useSPI) {
+        detachSPI();
+        _useSPI = false;
+    }
     _initialized = false;
 }
 
+// Checks if clock and data pin are the pins of a hardware SPI and hands them over to it.
+// Otherwise the registers are bit-banged via shiftOut(), which works on any pin.
+bool MFOutputShifter::attachSPI()
+{
+#if defined(ARDUINO_ARCH_AVR)
+    if (_clockPin != SCK || _dataPin != MOSI)
+        return false;
+    // SPI.begin() also sets SS to output, otherwise the SPI could fall back into slave mode.
+    // While the SPI is enabled MISO can only be used as input. So the hardware SPI is
+    // only used if no other device is connected to SS or MISO.
+    if (!spiPinsAvailable())
+        return false;
+    SPI.begin();
+    return true;
+#elif defined(ARDUINO_ARCH_RP2040)
+    // Each GPIO has a fixed SPI function: bits 0..1 select RX/CSn/SCK/TX and bit 3 the SPI block
+    if (_clockPin > 29 || _dataPin > 29)
+        return false;
+    if ((_clockPin & 0x03) != 2 || (_dataPin & 0x03) != 3 || ((_clockPin ^ _dataPin) & 0x08))
+        return false;
+    _spi = (_clockPin & 0x08) ? spi1 : spi0;
+    if (!MFSpiBlock::claim(_spi, MFSpiBlock::USER_OUTPUT_SHIFTER, MF_OUTPUTSHIFTER_SPI_CLOCK))
+        return false;
+    // only clock and data are routed to the SPI, RX and CS pins stay free for other devices
+    gpio_set_function(_clockPin, GPIO_FUNC_SPI);
+    gpio_set_function(_dataPin, GPIO_FUNC_SPI);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MFOutputShifter::detachSPI()
+{
+#if defined(ARDUINO_ARCH_AVR)
+    SPI.end();
+#elif defined(ARDUINO_ARCH_RP2040)
+    // the block and the pins are only released if no input shifter is using them,
+    // the pins get reconfigured anyway by the next device using them
+    if (MFSpiBlock::release(_spi)) {
+        pinMode(_clockPin, OUTPUT);
+        pinMode(_dataPin, OUTPUT);
+    }
+#endif
+}
+
 void MFOutputShifter::clear()
 {
     for (uint8_t i = 0; i < _moduleCount; i++) {
@@ -75,23 +164,57 @@ void MFOutputShifter::clear()
     update();
 }
 
-void MFOutputShifter::update()
+void MFOutputShifter::beginShift()
 {
+    // the settings are applied on each transfer as input shifters or other libraries
+    // might use the SPI with different settings
+#if defined(ARDUINO_ARCH_AVR)
+    if (_useSPI) SPI.beginTransaction(SPISettings(MF_OUTPUTSHIFTER_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+#elif defined(ARDUINO_ARCH_RP2040)
+    if (_useSPI) spi_set_format(_spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+#endif
     digitalWrite(_latchPin, LOW);
-    for (uint8_t i = _moduleCount; i > 0; i--) {
-        shiftOut(_dataPin, _clockPin, MSBFIRST, _lastState[i - 1]); // LSBFIRST, MSBFIRST,
+}
+
+void MFOutputShifter::shiftByte(uint8_t value)
+{
+    if (_useSPI) {
+#if defined(ARDUINO_ARCH_AVR)
+        SPI.transfer(value);
+#elif defined(ARDUINO_ARCH_RP2040)
+        spi_write_blocking(_spi, &value, 1); // returns after the byte is clocked out
+#endif
+    } else {
+        shiftOut(_dataPin, _clockPin, MSBFIRST, value); // LSBFIRST, MSBFIRST,
     }
+}
+
+void MFOutputShifter::endShift()
+{
     digitalWrite(_latchPin, HIGH);
+#if defined(ARDUINO_ARCH_AVR)
+    if (_useSPI) SPI.endTransaction();
+#endif
+}
+
+void MFOutputShifter::update()
+{
+    _dirty = false;
+    beginShift();
+    for (uint8_t i = _moduleCount; i > 0; i--) {
+        shiftByte(_lastState[i - 1]);
+    }
+    endShift();
 }
 
 void MFOutputShifter::powerSavingMode(bool state)
 {
     if (state) {
-        digitalWrite(_latchPin, LOW);
+        beginShift();
         for (uint8_t i = _moduleCount; i > 0; i--) {
-            shiftOut(_dataPin, _clockPin, MSBFIRST, 0xFF * MF_LOW);
+            shiftByte(0xFF * MF_LOW);
         }
-        digitalWrite(_latchPin, HIGH);
+        endShift();
     } else {
         update();
     }
@@ -7,6 +7,9 @@
 #pragma once
 
 #include <Arduino.h>
+#if defined(ARDUINO_ARCH_RP2040)
+#include <hardware/spi.h>
+#endif
 
 #ifdef REVERSED_OUTPUT_OUTPUTSHIFTER
     #define MF_HIGH LOW
@@ -16,12 +19,19 @@
     #define MF_LOW  LOW
 #endif
 
+// Clock rate if the shift registers are driven by the hardware SPI
+#ifndef MF_OUTPUTSHIFTER_SPI_CLOCK
+    #define MF_OUTPUTSHIFTER_SPI_CLOCK 4000000
+#endif
+
 class MFOutputShifter
 {
 public:
     MFOutputShifter();
     void setPin(uint8_t pin, uint8_t value, uint8_t refresh = 1);
     void setPins(char *pins, uint8_t value);
+    void setMask(uint8_t module, uint32_t mask, uint32_t values);
+    void flush();
     bool attach(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin, uint8_t moduleCount);
     void detach();
     void clear();
@@ -35,6 +45,17 @@ private:
     uint8_t _moduleCount; // Number of 8 bit modules in series. For a shift register with 16 bit one needs to select 2 modules a 8......
     uint8_t *_lastState;
     bool    _initialized = false;
+    bool    _useSPI      = false; // clock and data pin are connected to the hardware SPI
+    bool    _dirty       = false; // _lastState has changed and is not shifted out yet
+#if defined(ARDUINO_ARCH_RP2040)
+    spi_inst_t *_spi;
+#endif
+
+    bool attachSPI();
+    void detachSPI();
+    void beginShift();
+    void shiftByte(uint8_t value);
+    void endShift();
 };
 
 // MFOutputShifter.h
@@ -30,7 +30,8 @@ namespace OutputShifter
         outputShifter[outputShifterRegistered] = MFOutputShifter();
         if (!outputShifter[outputShifterRegistered].attach(latchPin, clockPin, dataPin, modules))
         {
-            cmdMessenger.sendCmd(kStatus, F("OutputShifter array does not fit into Memory"));
+            if (!GetMemoryTrial())
+                cmdMessenger.sendCmd(kStatus, F("OutputShifter array does not fit into Memory"));
             return;
         }
         outputShifterRegistered++;
@@ -47,6 +48,7 @@ namespace OutputShifter
         }
 
         outputShifterRegistered = 0;
+        maxOutputShifter        = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared Output Shifter"));
 #endif
@@ -61,6 +63,26 @@ namespace OutputShifter
         outputShifter[module].setPins(pins, value);
     }
 
+    void OnSetMask()
+    {
+        uint8_t  module      = (uint8_t)cmdMessenger.readInt16Arg();
+        uint8_t  firstModule = (uint8_t)cmdMessenger.readInt16Arg();  // first 8 bit register the mask applies to
+        uint32_t mask        = (uint32_t)cmdMessenger.readInt32Arg(); // bit set -> pin gets changed, sent as signed 32 bit
+        uint32_t values      = (uint32_t)cmdMessenger.readInt32Arg(); // bit set -> pin on, sent as signed 32 bit
+        if (module >= outputShifterRegistered)
+            return;
+        outputShifter[module].setMask(firstModule, mask, values);
+    }
+
+    // Pin changes are collected and latched once per loop,
+    // regardless of how many messages have been received
+    void update()
+    {
+        for (uint8_t i = 0; i < outputShifterRegistered; i++) {
+            outputShifter[i].flush();
+        }
+    }
+
     void PowerSave(bool state)
     {
         for (uint8_t i = 0; i < outputShifterRegistered; ++i) {
@@ -12,6 +12,8 @@ namespace OutputShifter
     void Add(uint8_t latchPin, uint8_t clockPin, uint8_t dataPin, uint8_t modules);
     void Clear();
     void OnSet();
+    void OnSetMask();
+    void update();
     void PowerSave(bool state);
 }
 
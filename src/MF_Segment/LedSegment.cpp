@@ -7,6 +7,7 @@
 #include "mobiflight.h"
 #include "MFSegments.h"
 #include "LedSegment.h"
+#include "IOCore.h"
 
 namespace LedSegment
 {
@@ -32,7 +33,8 @@ namespace LedSegment
 
         if (!ledSegments[ledSegmentsRegistered].attach(type, dataPin, csPin, clkPin, numDevices, brightness))
         {
-            cmdMessenger.sendCmd(kStatus, F("Led Segment array does not fit into Memory"));
+            if (!GetMemoryTrial())
+                cmdMessenger.sendCmd(kStatus, F("Led Segment array does not fit into Memory"));
             return;
         }
 
@@ -47,25 +49,62 @@ namespace LedSegment
         for (uint8_t i = 0; i < ledSegmentsRegistered; i++) {
             ledSegments[i].detach();
         }
-        ledSegmentsRegistered = 0;
+        ledSegmentsRegistered  = 0;
+        ledSegmentsRegistereds = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared segments"));
 #endif
     }
 
-    void PowerSave(bool state)
+    // The following functions are accessing the hardware, with IO_ON_2ND_CORE
+    // they are executed on the 2nd core which transmits the display content
+    void powerSave(uint8_t state, uint8_t = 0, uint8_t = 0, uint8_t = 0)
     {
         for (uint8_t i = 0; i < ledSegmentsRegistered; ++i) {
             ledSegments[i].powerSavingMode(state);
         }
     }
 
+    void setBrightness(uint8_t module, uint8_t subModule, uint8_t brightness, uint8_t = 0)
+    {
+        if (module >= ledSegmentsRegistered)
+            return;
+        ledSegments[module].setBrightness(subModule, brightness);
+    }
+
+    void setSingleSegment(uint8_t module, uint8_t subModule, uint8_t segment, uint8_t on_off)
+    {
+        if (module >= ledSegmentsRegistered)
+            return;
+        ledSegments[module].setSingleSegment(subModule, segment, on_off);
+    }
+
+    void PowerSave(bool state)
+    {
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::call(1 << kTaskSegments, powerSave, state);
+#else
+        powerSave(state);
+#endif
+    }
+
+    void update()
+    {
+        for (uint8_t i = 0; i < ledSegmentsRegistered; ++i) {
+            ledSegments[i].update();
+        }
+    }
+
     void OnInitModule()
     {
         int module     = cmdMessenger.readInt16Arg();
         int subModule  = cmdMessenger.readInt16Arg();
         int brightness = cmdMessenger.readInt16Arg();
-        ledSegments[module].setBrightness(subModule, brightness);
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::call(1 << kTaskSegments, setBrightness, module, subModule, brightness);
+#else
+        setBrightness(module, subModule, brightness);
+#endif
     }
 
     void OnSetModule()
@@ -83,7 +122,11 @@ namespace LedSegment
         int module     = cmdMessenger.readInt16Arg();
         int subModule  = cmdMessenger.readInt16Arg();
         int brightness = cmdMessenger.readInt16Arg();
-        ledSegments[module].setBrightness(subModule, brightness);
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        IOCore::call(1 << kTaskSegments, setBrightness, module, subModule, brightness);
+#else
+        setBrightness(module, subModule, brightness);
+#endif
     }
 
     void OnSetModuleSingleSegment()
@@ -96,7 +139,11 @@ namespace LedSegment
         char *pinTokens = strtok(segment, "|");
         while (pinTokens != 0) {
             uint8_t num = (uint8_t)atoi(pinTokens);
-            ledSegments[module].setSingleSegment(subModule, num, on_off);
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+            IOCore::call(1 << kTaskSegments, setSingleSegment, module, subModule, num, on_off);
+#else
+            setSingleSegment(module, subModule, num, on_off);
+#endif
             pinTokens = strtok(0, "|");
         }
     }
@@ -6,23 +6,54 @@
 
 #include "MFSegments.h"
 #include "commandmessenger.h"
+#include "allocateMem.h"
 
 MFSegments::MFSegments()
 {
     _moduleCount = 0;
 }
 
+// Only stores the latest value for the module, update() displays it
 void MFSegments::display(uint8_t module, char *string, uint8_t points, uint8_t mask, bool convertPoints)
 {
-    if (_moduleCount == 0)
+    if (_moduleCount == 0 || module >= _moduleCount)
+        return;
+    strncpy(_mailbox[module].value, string, sizeof(_mailbox[module].value));
+    _mailbox[module].points = points;
+    _mailbox[module].mask   = mask;
+    // the value must be visible to update() before the new gen
+    __atomic_store_n(&_mailbox[module].gen, (uint8_t)(_mailbox[module].gen + 1), __ATOMIC_RELEASE);
+}
+
+// Displays the pending values, but not more often than every MF_SEGMENT_REFRESH_MS.
+// Values received in between overwrite the pending ones, only the latest one is displayed.
+void MFSegments::update()
+{
+    if (_moduleCount == 0 || millis() - _lastUpdate < MF_SEGMENT_REFRESH_MS)
         return;
-    uint8_t digit = 8;
-    uint8_t pos   = 0;
+    bool updated = false;
+    for (uint8_t module = 0; module < _moduleCount; module++) {
+        if (_isPending(module)) {
+            _display(module);
+            updated = true;
+        }
+    }
+    if (updated)
+        _lastUpdate = millis();
+}
+
+void MFSegments::_display(uint8_t module)
+{
+    segmentMailbox *mailbox = &_mailbox[module];
+    uint8_t         digit   = 8;
+    uint8_t         pos     = 0;
+
+    mailbox->shownGen = __atomic_load_n(&mailbox->gen, __ATOMIC_ACQUIRE);
     for (uint8_t i = 0; i < 8; i++) {
         digit--;
-        if (((1 << digit) & mask) == 0)
+        if (((1 << digit) & mailbox->mask) == 0)
             continue;
-        _ledControl.setChar(module, digit, string[pos], ((1 << digit) & points));
+        _ledControl.setChar(module, digit, mailbox->value[pos], ((1 << digit) & mailbox->points));
         pos++;
     }
 }
@@ -31,7 +62,11 @@ void MFSegments::setSingleSegment(uint8_t module, uint8_t segment, uint8_t on_of
 {
     if (_moduleCount == 0)
         return;
-    
+
+    // a pending value has been received before and must not overwrite this segment later
+    if (module < _moduleCount && _isPending(module))
+        _display(module);
+
     _ledControl.setSingleSegment(module, segment, on_off);
 
 }
@@ -56,6 +91,12 @@ bool MFSegments::attach(uint8_t type, uint8_t dataPin, uint8_t csPin, uint8_t cl
     if (!_ledControl.begin(type, dataPin, clkPin, csPin, moduleCount))
         return false;
 
+    if (!FitInMemory(sizeof(segmentMailbox) * moduleCount))
+        return false;
+    _mailbox = (segmentMailbox *)allocateMemory(sizeof(segmentMailbox) * moduleCount);
+    memset(_mailbox, 0, sizeof(segmentMailbox) * moduleCount);
+    _lastUpdate = 0;
+
     _moduleCount = moduleCount;
 
     for (uint8_t i = 0; i < _moduleCount; ++i) {
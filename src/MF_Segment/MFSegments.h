@@ -9,11 +9,17 @@
 #include <Arduino.h>
 #include <LedControl_dual.h>
 
+// Min. time between two refreshes of a display, values received in between are combined
+#ifndef MF_SEGMENT_REFRESH_MS
+#define MF_SEGMENT_REFRESH_MS 20
+#endif
+
 class MFSegments
 {
 public:
     MFSegments();
     void display(uint8_t module, char *string, uint8_t points, uint8_t mask, bool convertPoints = false);
+    void update();
     bool attach(uint8_t type, uint8_t dataPin, uint8_t csPin, uint8_t clkPin, uint8_t moduleCount, uint8_t brightness);
     void detach();
     void test();
@@ -22,8 +28,24 @@ public:
     void setSingleSegment(uint8_t module, uint8_t segment, uint8_t on_off);
 
 private:
-    LedControl _ledControl;
-    uint8_t       _moduleCount;
+    // latest value received for a module, transmitted by update()
+    // display() and update() can run on different cores, so counters written
+    // by only one side are used instead of a pending flag
+    struct segmentMailbox {
+        char             value[8];
+        uint8_t          points;
+        uint8_t          mask;
+        volatile uint8_t gen;      // incremented for each new value by display()
+        uint8_t          shownGen; // gen of the displayed value
+    };
+
+    LedControl      _ledControl;
+    uint8_t         _moduleCount;
+    uint32_t        _lastUpdate;
+    segmentMailbox *_mailbox;
+
+    bool _isPending(uint8_t module) { return __atomic_load_n(&_mailbox[module].gen, __ATOMIC_ACQUIRE) != _mailbox[module].shownGen; }
+    void _display(uint8_t module);
 };
 
 // MFSegments.h
@@ -5,53 +5,186 @@
 //
 
 #include "MFServo.h"
+#if defined(ARDUINO_ARCH_RP2040)
+#include "MFOutput.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+
+uint16_t MFServo::_pwmChannelsUsed = 0;
+#endif
+
+int16_t MFServo::degToPulse(int degree)
+{
+    return MF_SERVO_MIN_PULSE + (int32_t)degree * (MF_SERVO_MAX_PULSE - MF_SERVO_MIN_PULSE) / 180;
+}
 
 void MFServo::moveTo(int absolute)
 {
-    int newValue = map(absolute, _mapRange[0], _mapRange[1], _mapRange[2], _mapRange[3]);
+    // map directly into µs to get sub-degree resolution
+    int32_t newValue = map(absolute, _mapRange[0], _mapRange[1], degToPulse(_mapRange[2]), degToPulse(_mapRange[3]));
+    newValue         = constrain(newValue, MF_SERVO_MIN_PULSE, MF_SERVO_MAX_PULSE);
     if (_targetPos != newValue) {
         _targetPos = newValue;
         if (!_initialized) {
-#if defined(ARDUINO_ARCH_RP2040)
-            _servo.attach(_pin, 544, 2400);
-#else
-            _servo.attach(_pin);
-#endif
+            attachOutput();
             _initialized = true;
+            _lastUpdate  = millis();
         }
     }
 }
 
+void MFServo::setSpeedAccel(uint16_t maxSpeed, uint16_t maxAccel)
+{
+    _maxSpeed = maxSpeed;
+    _maxAccel = maxAccel;
+}
+
 void MFServo::update()
 {
+    if (!_initialized)
+        return;
+
+    uint16_t now = millis();
+    uint16_t dt  = now - _lastUpdate;
+    _lastUpdate  = now;
+    if (dt > MF_SERVO_MAX_DT_MS)
+        dt = MF_SERVO_MAX_DT_MS;
+
+    int32_t distance = ((int32_t)_targetPos << 8) - _currentPos;
+
     // after reaching final position
     // detach the servo to prevent continuous noise
-    if (_currentPos == _targetPos) {
+    if (distance == 0 && _velocity == 0) {
         // detach();
         return;
     }
 
-    if (_currentPos > _targetPos)
-        _currentPos--;
-    else
-        _currentPos++;
+    if (_maxSpeed == 0) {
+        // no speed limit, jump to the target
+        _currentPos = (int32_t)_targetPos << 8;
+        _velocity   = 0;
+    } else {
+        int32_t maxVelocity = (int32_t)_maxSpeed << 8;
+        if (distance < 0)
+            maxVelocity = -maxVelocity;
+
+        if (_maxAccel == 0) {
+            _velocity = maxVelocity;
+        } else {
+            // distance required to stop with the current velocity: v² / 2a
+            uint32_t speed      = labs(_velocity) >> 8;
+            uint32_t stopDist   = speed * speed / 2 / _maxAccel;
+            int32_t  deltaV     = (int32_t)_maxAccel * dt * 256 / 1000;
+            bool     sameDir    = (distance >= 0) == (_velocity >= 0);
+            int32_t  desiredVel = (sameDir && stopDist < (uint32_t)(labs(distance) >> 8)) ? maxVelocity : 0;
+
+            if (_velocity < desiredVel)
+                _velocity = min(_velocity + deltaV, desiredVel);
+            else if (_velocity > desiredVel)
+                _velocity = max(_velocity - deltaV, desiredVel);
+            // ensure to reach the target if decelerated before
+            if (_velocity == 0 && desiredVel == 0)
+                _velocity = (distance > 0) ? deltaV : -deltaV;
+        }
 
-    _servo.write(_currentPos);
+        int32_t step = _velocity * dt / 1000;
+        // target reached or crossed
+        if ((distance >= 0 && step >= distance) || (distance <= 0 && step <= distance)) {
+            _currentPos = (int32_t)_targetPos << 8;
+            _velocity   = 0;
+        } else {
+            _currentPos += step;
+        }
+    }
+
+    int16_t pulse = (_currentPos + 128) >> 8;
+    if (pulse != _lastPulse) {
+        writePulse(pulse);
+        _lastPulse = pulse;
+    }
 }
 
 void MFServo::detach()
 {
     if (_initialized) {
-        _servo.detach();
+        detachOutput();
         _initialized = false;
     }
 }
 
+void MFServo::attachOutput()
+{
+#if defined(ARDUINO_ARCH_RP2040)
+    uint8_t  slice   = pwm_gpio_to_slice_num(_pin);
+    uint16_t channel = 1 << (slice * 2 + pwm_gpio_to_channel(_pin));
+    // pins 16 apart share the same PWM channel, only the first one can use it.
+    // The slice timing is changed for the servo pulses, so the slice can only be used
+    // if no output pin is dimmed by analogWrite() on it.
+    _usePwm = !(_pwmChannelsUsed & channel) && !MFOutput::isPwmSliceUsed(slice);
+    if (_usePwm) {
+        // the other channel of the slice is already running with the servo timing
+        if (!(_pwmChannelsUsed & (3 << (slice * 2)))) {
+            pwm_config config = pwm_get_default_config();
+            // one counter tick per µs, so the compare value is the pulse width
+            pwm_config_set_clkdiv(&config, clock_get_hz(clk_sys) / 1000000.0f);
+            pwm_config_set_wrap(&config, MF_SERVO_PWM_PERIOD_US - 1);
+            pwm_init(slice, &config, false);
+        }
+        _pwmChannelsUsed |= channel;
+        // no pulse until the first position is written
+        pwm_set_chan_level(slice, pwm_gpio_to_channel(_pin), 0);
+        pwm_set_enabled(slice, true);
+        gpio_set_function(_pin, GPIO_FUNC_PWM);
+        _lastPulse = -1;
+        return;
+    }
+#endif
+    _servo.attach(_pin, MF_SERVO_MIN_PULSE, MF_SERVO_MAX_PULSE);
+}
+
+void MFServo::detachOutput()
+{
+#if defined(ARDUINO_ARCH_RP2040)
+    if (_usePwm) {
+        uint8_t slice = pwm_gpio_to_slice_num(_pin);
+        pwm_set_chan_level(slice, pwm_gpio_to_channel(_pin), 0);
+        _pwmChannelsUsed &= ~(1 << (slice * 2 + pwm_gpio_to_channel(_pin)));
+        if (!(_pwmChannelsUsed & (3 << (slice * 2))))
+            pwm_set_enabled(slice, false);
+        gpio_set_function(_pin, GPIO_FUNC_SIO);
+        _usePwm = false;
+        return;
+    }
+#endif
+    _servo.detach();
+}
+
+void MFServo::writePulse(int16_t pulse)
+{
+#if defined(ARDUINO_ARCH_RP2040)
+    if (_usePwm) {
+        // the compare value is double buffered and takes effect with the next period,
+        // so no pulse gets cut and no CPU is required to generate the pulses
+        pwm_set_chan_level(pwm_gpio_to_slice_num(_pin), pwm_gpio_to_channel(_pin), pulse);
+        return;
+    }
+#endif
+    _servo.writeMicroseconds(pulse);
+}
+
 void MFServo::attach(uint8_t pin, bool enable)
 {
     _initialized = false;
-    _targetPos   = 0;
-    _currentPos  = 0;
+    _targetPos   = MF_SERVO_MIN_PULSE;
+    _currentPos  = (int32_t)MF_SERVO_MIN_PULSE << 8;
+    _velocity    = 0;
+    _lastPulse   = -1;
+    _maxSpeed    = MF_SERVO_DEFAULT_SPEED;
+    _maxAccel    = 0;
+#if defined(ARDUINO_ARCH_RP2040)
+    _usePwm = false;
+#endif
     setExternalRange(0, 180);
     setInternalRange(0, 180);
     _pin = pin;
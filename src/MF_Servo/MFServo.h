@@ -9,6 +9,22 @@
 #include <Arduino.h>
 #include <Servo.h>
 
+// pulse width in µs for 0° and 180°
+#define MF_SERVO_MIN_PULSE 544
+#define MF_SERVO_MAX_PULSE 2400
+// default speed in µs/s, same as the former 1° every 5ms
+#ifndef MF_SERVO_DEFAULT_SPEED
+#define MF_SERVO_DEFAULT_SPEED ((MF_SERVO_MAX_PULSE - MF_SERVO_MIN_PULSE) * 1000L / (180L * 5))
+#endif
+// max. time step for one update, longer delays would result in jumps
+#define MF_SERVO_MAX_DT_MS 50
+
+#if defined(ARDUINO_ARCH_RP2040)
+// servo pulses are generated by the PWM slices, the Servo library is only used
+// if the PWM channel of the pin is already used by another servo or the slice by an output
+#define MF_SERVO_PWM_PERIOD_US 20000
+#endif
+
 class MFServo
 {
 public:
@@ -17,17 +33,32 @@ public:
     void detach();
     void setExternalRange(int min, int max);
     void setInternalRange(int min, int max);
+    void setSpeedAccel(uint16_t maxSpeed, uint16_t maxAccel);
     void moveTo(int absolute);
     void update();
 
 private:
-    uint8_t _pin;
-    int     _mapRange[4];
-    bool    _initialized;
-    Servo   _servo;
-    long    _targetPos;
-    long    _currentPos;
-    int     speed;
+    uint8_t  _pin;
+    int      _mapRange[4];
+    bool     _initialized;
+    Servo    _servo;
+    int16_t  _targetPos;  // target pulse width in µs
+    int32_t  _currentPos; // current pulse width in 1/256 µs
+    int32_t  _velocity;   // current velocity in 1/256 µs/s, signed
+    uint16_t _maxSpeed;   // in µs/s, 0 = no speed limit
+    uint16_t _maxAccel;   // in µs/s², 0 = no acceleration ramp
+    uint16_t _lastUpdate; // low word of millis() is sufficient for the time step
+    int16_t  _lastPulse;
+#if defined(ARDUINO_ARCH_RP2040)
+    bool     _usePwm;
+
+    static uint16_t _pwmChannelsUsed; // one bit per PWM channel, bit = slice * 2 + channel
+#endif
+
+    static int16_t degToPulse(int degree);
+    void           attachOutput();
+    void           detachOutput();
+    void           writePulse(int16_t pulse);
 };
 
-// MFServo.h
\ No newline at end of file
+// MFServo.h
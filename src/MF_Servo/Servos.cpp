@@ -41,6 +41,7 @@ namespace Servos
             servos[i].detach();
         }
         servosRegistered = 0;
+        maxServos        = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared servos"));
 #endif
@@ -55,6 +56,19 @@ namespace Servos
         servos[servo].moveTo(newValue);
     }
 
+    void OnSetSpeedAccel()
+    {
+        uint8_t  servo    = (uint8_t)cmdMessenger.readInt16Arg();
+        // unsigned 16 bit values, read as 32 bit to not get negative values above 32767
+        int32_t  speed    = cmdMessenger.readInt32Arg();
+        int32_t  accel    = cmdMessenger.readInt32Arg();
+        uint16_t maxSpeed = constrain(speed, 0L, 0xFFFFL);
+        uint16_t maxAccel = constrain(accel, 0L, 0xFFFFL);
+        if (servo >= servosRegistered)
+            return;
+        servos[servo].setSpeedAccel(maxSpeed, maxAccel);
+    }
+
     void update()
     {
         for (uint8_t i = 0; i < servosRegistered; i++) {
@@ -12,6 +12,7 @@ namespace Servos
     void Add(uint8_t pin);
     void Clear();
     void OnSet();
+    void OnSetSpeedAccel();
     void update();
 }
 
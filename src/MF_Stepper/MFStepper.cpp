@@ -27,7 +27,8 @@ void MFStepper::attach(uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4, u
 {
     if (!FitInMemory(sizeof(AccelStepper))) {
         // Error Message to Connector
-        cmdMessenger.sendCmd(kStatus, F("MFStepper does not fit in Memory"));
+        if (!GetMemoryTrial())
+            cmdMessenger.sendCmd(kStatus, F("MFStepper does not fit in Memory"));
         return;
     }
     uint16_t maxSpeed = 0;
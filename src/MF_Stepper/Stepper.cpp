@@ -7,26 +7,50 @@
 #include "mobiflight.h"
 #include "MFStepper.h"
 #include "Stepper.h"
-#if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-#include <FreeRTOS.h>
-#endif
 
 namespace Stepper
 {
     MFStepper *steppers;
     uint8_t    steppersRegistered = 0;
     uint8_t    maxSteppers        = 0;
-#if defined(STEPPER_ON_2ND_CORE)
-    enum {
-        FUNC_MOVETO = 1,
-        FUNC_ZETZERO,
-        FUNC_SPEEDACCEL,
-        START_STOP_2ND_CORE
-    };
+#if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    // Commands for the 2nd core are written into one slot per stepper, so the 1st core
+    // never waits for the 2nd core. A new value overwrites a not yet processed one,
+    // only the latest target gets executed. Each field is written by one core only,
+    // the sequence numbers are written after the values and keep the order of the commands.
+    typedef struct {
+        volatile int32_t  target;
+        volatile uint32_t speedAccel; // maxSpeed << 16 | maxAccel, one word to be read consistently
+        volatile uint32_t targetSeq;
+        volatile uint32_t zeroSeq;
+        volatile uint32_t speedAccelSeq;
+        uint32_t          doneTargetSeq; // only used by the 2nd core
+        uint32_t          doneZeroSeq;
+        uint32_t          doneSpeedAccelSeq;
+    } stepperSlot;
+
+    stepperSlot  *slots;
+    uint32_t      commandSeq    = 0;
+    volatile bool stopRequested = false; // only written by the 1st core
+    volatile bool stopped       = false; // only written by the 2nd core
+
+    uint32_t nextSeq()
+    {
+        // values must be visible to the 2nd core before the sequence number
+        __sync_synchronize();
+        return ++commandSeq;
+    }
 #endif
 
     bool setupArray(uint16_t count)
     {
+#if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+        // each allocation gets aligned, so both are checked separately
+        if (!FitInMemory(sizeof(stepperSlot) * count))
+            return false;
+        slots = (stepperSlot *)allocateMemory(sizeof(stepperSlot) * count);
+        memset((void *)slots, 0, sizeof(stepperSlot) * count);
+#endif
         if (!FitInMemory(sizeof(MFStepper) * count))
             return false;
         steppers    = new (allocateMemory(sizeof(MFStepper) * count)) MFStepper;
@@ -60,6 +84,7 @@ namespace Stepper
             steppers[i].detach();
         }
         steppersRegistered = 0;
+        maxSteppers        = 0;
 #ifdef DEBUG2CMDMESSENGER
         cmdMessenger.sendCmd(kDebug, F("Cleared steppers"));
 #endif
@@ -73,12 +98,8 @@ namespace Stepper
         if (stepper >= steppersRegistered)
             return;
 #if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-        // wait for 2nd core
-        rp2040.fifo.pop();
-        rp2040.fifo.push(FUNC_MOVETO);
-        rp2040.fifo.push(stepper);
-        rp2040.fifo.push(newPos);
-        rp2040.fifo.push(false);
+        slots[stepper].target    = newPos;
+        slots[stepper].targetSeq = nextSeq();
 #else
         steppers[stepper].moveTo(newPos);
 #endif
@@ -100,12 +121,7 @@ namespace Stepper
         if (stepper >= steppersRegistered)
             return;
 #if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-        // wait for 2nd core
-        rp2040.fifo.pop();
-        rp2040.fifo.push(FUNC_ZETZERO);
-        rp2040.fifo.push(stepper);
-        rp2040.fifo.push(false);
-        rp2040.fifo.push(false);
+        slots[stepper].zeroSeq = nextSeq();
 #else
         steppers[stepper].setZero();
 #endif
@@ -120,11 +136,8 @@ namespace Stepper
         if (stepper >= steppersRegistered)
             return;
 #if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
-        rp2040.fifo.pop(); // wait for 2nd core
-        rp2040.fifo.push(FUNC_SPEEDACCEL);
-        rp2040.fifo.push(stepper);
-        rp2040.fifo.push(maxSpeed);
-        rp2040.fifo.push(maxAccel);
+        slots[stepper].speedAccel    = ((uint32_t)maxSpeed << 16) | maxAccel;
+        slots[stepper].speedAccelSeq = nextSeq();
 #else
         steppers[stepper].setMaxSpeed(maxSpeed);
         steppers[stepper].setAcceleration(maxAccel);
@@ -150,16 +163,42 @@ namespace Stepper
 #if defined(STEPPER_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
     void stopUpdate2ndCore(bool stop)
     {
-        // wait for 2nd core
-        rp2040.fifo.pop();
-        // send command to stop/start updating to 2nd core
-        rp2040.fifo.push(START_STOP_2ND_CORE);
-        // communication is always done using 4 messages
-        rp2040.fifo.push(0);
-        rp2040.fifo.push(stop);
-        rp2040.fifo.push(0);
-        // wait for execution of command
-        rp2040.fifo.pop();
+        // this is the only case the 1st core waits for the 2nd core
+        stopRequested = stop;
+        while (stopped != stop)
+            ;
+    }
+
+    // executes the latest commands for a stepper, called on the 2nd core
+    void processSlot(uint8_t stepper)
+    {
+        stepperSlot *slot          = &slots[stepper];
+        uint32_t     targetSeq     = slot->targetSeq;
+        uint32_t     zeroSeq       = slot->zeroSeq;
+        uint32_t     speedAccelSeq = slot->speedAccelSeq;
+        // sequence numbers are read before the values
+        __sync_synchronize();
+
+        if (speedAccelSeq != slot->doneSpeedAccelSeq) {
+            uint32_t speedAccel = slot->speedAccel;
+            steppers[stepper].setMaxSpeed(speedAccel >> 16);
+            steppers[stepper].setAcceleration(speedAccel & 0xFFFF);
+            slot->doneSpeedAccelSeq = speedAccelSeq;
+        }
+        bool newTarget = targetSeq != slot->doneTargetSeq;
+        bool newZero   = zeroSeq != slot->doneZeroSeq;
+        // a target received before setting zero must be executed first
+        if (newTarget && newZero && (int32_t)(zeroSeq - targetSeq) > 0) {
+            steppers[stepper].moveTo(slot->target);
+            newTarget = false;
+        }
+        if (newZero) {
+            steppers[stepper].setZero();
+            slot->doneZeroSeq = zeroSeq;
+        }
+        if (newTarget)
+            steppers[stepper].moveTo(slot->target);
+        slot->doneTargetSeq = targetSeq;
     }
 #endif
 } // namespace
@@ -174,41 +213,20 @@ namespace Stepper
 ********************************************************************************** */
 void setup1()
 {
-    // send "ready" message to 1st core
-    rp2040.fifo.push(true);
 }
 
 void loop1()
 {
-    uint8_t command, stepper;
-    int32_t param1, param2;
-    bool    stopUpdating = false;
-
     while (1) {
-        for (uint8_t i = 0; i < Stepper::steppersRegistered && !stopUpdating; ++i) {
+        bool stop = Stepper::stopRequested;
+        if (stop != Stepper::stopped)
+            Stepper::stopped = stop;
+        if (stop)
+            continue;
+        for (uint8_t i = 0; i < Stepper::steppersRegistered; ++i) {
+            Stepper::processSlot(i);
             Stepper::steppers[i].update();
         }
-        if (rp2040.fifo.available()) {
-            command = (uint8_t)rp2040.fifo.pop();
-            stepper = (uint8_t)rp2040.fifo.pop();
-            param1  = (int32_t)rp2040.fifo.pop();
-            param2  = (int32_t)rp2040.fifo.pop();
-            if (command == Stepper::FUNC_MOVETO) {
-                Stepper::steppers[stepper].moveTo(param1);
-            } else if (command == Stepper::FUNC_ZETZERO) {
-                Stepper::steppers[stepper].setZero();
-            } else if (command == Stepper::FUNC_SPEEDACCEL) {
-                Stepper::steppers[stepper].setMaxSpeed(param1);
-                Stepper::steppers[stepper].setAcceleration(param2);
-            } else if (command == Stepper::START_STOP_2ND_CORE) {
-                stopUpdating = (bool)param1;
-                // inform core 0 that command has been executed
-                // it's additional needed in this case
-                rp2040.fifo.push(true);
-            }
-            // send ready for next message to 1st core
-            rp2040.fifo.push(true);
-        }
     }
 }
 #endif
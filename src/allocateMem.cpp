@@ -6,26 +6,39 @@
 
 #include "mobiflight.h"
 
-#if defined (ARDUINO_ARCH_AVR)
-uint8_t     deviceBuffer[MF_MAX_DEVICEMEM] = {0};
-#else
-std::size_t    deviceBuffer[MF_MAX_DEVICEMEM] = {0};
-#endif
+alignas(MF_MEM_ALIGN) uint8_t deviceBuffer[MF_MAX_DEVICEMEM] = {0};
 
 uint16_t nextPointer                    = 0;
+uint16_t peakPointer                    = 0;
+uint8_t  memOwner                       = kTypeNotSet;
+uint16_t memUsed[kTypeMax]              = {0};  // bytes per device type for the active config
+uint16_t memPeak[kTypeMax]              = {0};  // max. bytes per device type since power up
+uint16_t memEnd[kTypeMax]               = {0};  // end of the last allocation per device type
+bool     memTrial                       = false;
+bool     memOverflow                    = false;
 
-#if defined (ARDUINO_ARCH_AVR)
-uint8_t     *allocateMemory(uint16_t size)
-#else
-std::size_t    *allocateMemory(uint16_t size)
-#endif
+static uint16_t alignSize(uint16_t size)
 {
-    uint16_t actualPointer = nextPointer;
-    nextPointer            = actualPointer + size;
-    if (nextPointer >= MF_MAX_DEVICEMEM) {
-        cmdMessenger.sendCmd(kStatus, F("DeviceBuffer Overflow!"));
+    return (size + MF_MEM_ALIGN - 1) & ~(uint16_t)(MF_MEM_ALIGN - 1);
+}
+
+uint8_t *allocateMemory(uint16_t size)
+{
+    size = alignSize(size);
+    if (size > MF_MAX_DEVICEMEM - nextPointer) {
+        memOverflow = true;
+        if (!memTrial)
+            cmdMessenger.sendCmd(kStatus, F("DeviceBuffer Overflow!"));
         return nullptr;
     }
+    uint16_t actualPointer = nextPointer;
+    nextPointer            = actualPointer + size;
+    if (nextPointer > peakPointer)
+        peakPointer = nextPointer;
+    memEnd[memOwner] = nextPointer;
+    memUsed[memOwner] += size;
+    if (memUsed[memOwner] > memPeak[memOwner])
+        memPeak[memOwner] = memUsed[memOwner];
 #ifdef DEBUG2CMDMESSENGER
     cmdMessenger.sendCmdStart(kDebug);
     cmdMessenger.sendCmdArg(F("Bytes added"));
@@ -42,6 +55,24 @@ std::size_t    *allocateMemory(uint16_t size)
 void ClearMemory()
 {
     nextPointer = 0;
+    memOwner    = kTypeNotSet;
+    for (uint8_t i = 0; i < kTypeMax; i++) {
+        memUsed[i] = 0;
+        memEnd[i]  = 0;
+    }
+}
+
+// Releases the memory of one device type. Only the memory behind the last allocation
+// of all other types can be used again, gaps are released with the next ClearMemory()
+void ReleaseMemory(uint8_t type)
+{
+    memUsed[type] = 0;
+    memEnd[type]  = 0;
+    nextPointer   = 0;
+    for (uint8_t i = 0; i < kTypeMax; i++) {
+        if (memEnd[i] > nextPointer)
+            nextPointer = memEnd[i];
+    }
 }
 
 uint16_t GetAvailableMemory()
@@ -51,9 +82,55 @@ uint16_t GetAvailableMemory()
 
 bool FitInMemory(uint16_t size)
 {
-    if (nextPointer + size > MF_MAX_DEVICEMEM)
+    if (alignSize(size) > MF_MAX_DEVICEMEM - nextPointer) {
+        memOverflow = true;
         return false;
+    }
     return true;
 }
 
+// While a trial is running no overflow messages are sent, afterwards
+// MemoryOverflow() tells if all allocations during the trial were successful
+void SetMemoryTrial(bool trial)
+{
+    memTrial = trial;
+    if (trial)
+        memOverflow = false;
+}
+
+bool GetMemoryTrial()
+{
+    return memTrial;
+}
+
+bool MemoryOverflow()
+{
+    return memOverflow;
+}
+
+// all following allocations are accounted to this device type,
+// deprecated types are accounted to the type which replaces them
+void SetMemoryOwner(uint8_t type)
+{
+    memOwner = getDeviceGroup(type);
+}
+
+// response: used, free, peak for the whole buffer,
+// then type, used, peak for each device type which has ever allocated memory
+void OnGetMemoryStats()
+{
+    cmdMessenger.sendCmdStart(kMemoryStats);
+    cmdMessenger.sendCmdArg(nextPointer);
+    cmdMessenger.sendCmdArg(GetAvailableMemory());
+    cmdMessenger.sendCmdArg(peakPointer);
+    for (uint8_t i = 0; i < kTypeMax; i++) {
+        if (memPeak[i] == 0)
+            continue;
+        cmdMessenger.sendCmdArg(i);
+        cmdMessenger.sendCmdArg(memUsed[i]);
+        cmdMessenger.sendCmdArg(memPeak[i]);
+    }
+    cmdMessenger.sendCmdEnd();
+}
+
 // allocatemem.cpp
@@ -7,15 +7,25 @@
 #pragma once
 
 #include <new>
+#include <stddef.h>
+#include <stdint.h>
 
-#if defined (ARDUINO_ARCH_AVR)
-uint8_t     *allocateMemory(uint16_t size);
+// every allocation starts at a multiple of MF_MEM_ALIGN
+#if defined(ARDUINO_ARCH_AVR)
+#define MF_MEM_ALIGN 1 // 8 bit MCU, no alignment required
 #else
-std::size_t    *allocateMemory(uint16_t size);
+#define MF_MEM_ALIGN alignof(max_align_t)
 #endif
 
+uint8_t    *allocateMemory(uint16_t size);
 void        ClearMemory();
 uint16_t    GetAvailableMemory();
 bool        FitInMemory(uint16_t size);
+void        ReleaseMemory(uint8_t type);
+void        SetMemoryOwner(uint8_t type);
+void        SetMemoryTrial(bool trial);
+bool        GetMemoryTrial();
+bool        MemoryOverflow();
+void        OnGetMemoryStats();
 
 // allocatemem.h
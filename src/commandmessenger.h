@@ -26,7 +26,7 @@ enum {
     kSetConfig,            // 11
     kGetConfig,            // 12
     kResetConfig,          // 13
-    kSaveConfig,           // 14
+    kSaveConfig,           // 14, length, CRC of the config; optional after kSetConfig, required after kSetConfigChunk
     kConfigSaved,          // 15
     kActivateConfig,       // 16
     kConfigActivated,      // 17
@@ -46,6 +46,16 @@ enum {
     kSetStepperSpeedAccel, // 31
     kSetCustomDevice,      // 32
     kSetModuleSingleSegment, // 33
+    kSetShiftRegisterMask, // 34
+    kInputShifterChanges,  // 35, name, pin, event, pin, event, ... all changes of one input shifter if enabled by kSetInputShifterCompact
+    kSetServoSpeedAccel,   // 36, max. speed in µs/s (0 = no limit) and acceleration in µs/s² (0 = no ramp)
+    kSetTaskTiming,        // 37, task, period in ms (0 = every loop), phase in ms, priority (0 = highest); acknowledged by kStatus
+    kTaskStats,            // 38, request and response, per task: task, overruns, max. delay in ms since the last request
+    kSetConfigChunk,       // 39, offset, part of the config; acknowledged by kStatus with the next expected offset
+    kMemoryStats,          // 40, request and response: used, free, peak bytes, then per device type: type, used, peak bytes
+    kAnalogMuxChange,      // 41, name, channel, value
+    kKeyMatrixChange,      // 42, name, key index, event (like kButtonChange)
+    kSetInputShifterCompact, // 43, 1 = send kInputShifterChanges instead of kInputShifterChange, reset with each config and kGetInfo
     kDebug = 0xFF          // 255
 };
 
@@ -25,6 +25,9 @@ enum {
     kTypeStepper,              // 15 new stepper type with settings for backlash and deactivate output
     kTypeLedSegmentMulti,      // 16 new led segment with MAX7219 and TM1637 support
     kTypeCustomDevice,         // 17 Custom Device
+    kTypeDigInMuxCascade,      // 18 Two level cascade of digital input multiplexers, up to 256 inputs
+    kTypeAnalogMux,            // 19 Up to 16 analog inputs on one pin through a multiplexer
+    kTypeKeyMatrix,            // 20 Matrix of up to 8 x 8 keys
     kTypeMax                   // if new device types are added, this MUST be before this one!
 };
 
@@ -32,6 +35,7 @@ void loadConfig(void);
 bool getStatusConfig(void);
 void generateSerial(bool);
 void OnSetConfig(void);
+void OnSetConfigChunk(void);
 void OnResetConfig(void);
 void OnSaveConfig(void);
 void OnActivateConfig(void);
@@ -41,5 +45,9 @@ void OnGenNewSerial(void);
 void OnSetName(void);
 void restoreName(void);
 bool getBoardReady();
+uint8_t getDeviceGroup(uint8_t type);
+#if defined(ARDUINO_ARCH_AVR)
+bool spiPinsAvailable();
+#endif
 
 // config.h
\ No newline at end of file
@@ -9,8 +9,11 @@
 #include "Button.h"
 #include "Encoder.h"
 #include "MFEEPROM.h"
+#include "MFScheduler.h"
+#include "IOCore.h"
 #if MF_ANALOG_SUPPORT == 1
 #include "Analog.h"
+#include "AnalogMux.h"
 #endif
 #if MF_INPUT_SHIFTER_SUPPORT == 1
 #include "InputShifter.h"
@@ -33,6 +36,10 @@
 #endif
 #if MF_DIGIN_MUX_SUPPORT == 1
 #include "DigInMux.h"
+#include "DigInMuxCascade.h"
+#endif
+#if MF_KEYMATRIX_SUPPORT == 1
+#include "KeyMatrix.h"
 #endif
 #if MF_CUSTOMDEVICE_SUPPORT == 1
 #include "CustomDevice.h"
@@ -42,71 +49,116 @@
 #define MF_ENCODER_DEBOUNCE_MS    1  // time between encoder updates
 #define MF_INSHIFTER_POLL_MS      10 // time between input shift reg updates
 #define MF_INMUX_POLL_MS          10 // time between dig input mux updates
+#define MF_INMUX_CASCADE_POLL_MS  (MF_INMUX_POLL_MS / MF_INMUX_CASCADE_SLICES) // a full sweep of a mux cascade within MF_INMUX_POLL_MS
+#define MF_KEYMATRIX_POLL_MS      5  // time between key matrix scans, a key is debounced after two scans
 #define MF_SERVO_DELAY_MS         5  // time between servo updates
 #define MF_ANALOGAVERAGE_DELAY_MS 10 // time between updating the analog average calculation
 #define MF_ANALOGREAD_DELAY_MS    50 // time between sending analog values
+#define MF_ANALOGMUX_POLL_MS      2  // time between reading two channels of an analog mux
 
 bool                powerSavingMode   = false;
 const unsigned long POWER_SAVING_TIME = 60 * 15; // in seconds
 
-#if MF_MUX_SUPPORT == 1
-MFMuxDriver MUX;
-#endif
 // ==================================================
-//   Polling interval counters
+//   Scheduler for the polling of the devices
 // ==================================================
 
-typedef struct {
-    uint32_t Buttons  = 0;
-    uint32_t Encoders = 0;
-#if MF_SERVO_SUPPORT == 1
-    uint32_t Servos = 0;
-#endif
-#if MF_ANALOG_SUPPORT == 1
-    uint32_t AnalogAverage = 0;
-    uint32_t Analog        = 0;
-#endif
-#if MF_INPUT_SHIFTER_SUPPORT == 1
-    uint32_t InputShifters = 0;
-#endif
-#if MF_DIGIN_MUX_SUPPORT == 1
-    uint32_t DigInMux = 0;
-#endif
-#if MF_CUSTOMDEVICE_SUPPORT == 1
-    uint32_t CustomDevice = 0;
+MFScheduler scheduler;
+bool        schedulerRunning = false;
+// with IO_ON_2ND_CORE the inputs and displays are updated by the scheduler of the 2nd core
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+#define ioScheduler IOCore::scheduler
+#else
+#define ioScheduler scheduler
 #endif
-} lastUpdate_t;
-
-lastUpdate_t lastUpdate;
 
 extern MFEEPROM MFeeprom;
 
-void initPollIntervals(void)
+// Phases spread the polling over time, so the inputs are not read in the same loop
+void initScheduler(void)
 {
-    // Init Time Gap between Inputs, do not read at the same loop
-    lastUpdate.Buttons  = millis();
-    lastUpdate.Encoders = millis();
-#if MF_SERVO_SUPPORT == 1
-    lastUpdate.Servos = millis() + 2;
+    ioScheduler.add(kTaskEncoders, Encoder::read, MF_ENCODER_DEBOUNCE_MS, 0, 0);
+    ioScheduler.add(kTaskButtons, Button::read, MF_BUTTON_DEBOUNCE_MS, 0, 1);
+#if MF_STEPPER_SUPPORT == 1
+    scheduler.add(kTaskSteppers, Stepper::update, 0, 0, 0);
 #endif
-#if MF_ANALOG_SUPPORT == 1
-    lastUpdate.AnalogAverage = millis() + 4;
-    lastUpdate.Analog        = millis() + 4;
+#if MF_SERVO_SUPPORT == 1
+    scheduler.add(kTaskServos, Servos::update, MF_SERVO_DELAY_MS, 2, 1);
 #endif
 #if MF_INPUT_SHIFTER_SUPPORT == 1
-    lastUpdate.InputShifters = millis() + 6;
+    ioScheduler.add(kTaskInputShifters, InputShifter::read, MF_INSHIFTER_POLL_MS, 6, 2);
 #endif
 #if MF_DIGIN_MUX_SUPPORT == 1
-    lastUpdate.DigInMux = millis() + 8;
+    ioScheduler.add(kTaskDigInMux, DigInMux::read, MF_INMUX_POLL_MS, 8, 2);
+    ioScheduler.add(kTaskDigInMuxCascade, DigInMuxCascade::read, MF_INMUX_CASCADE_POLL_MS, 1, 2);
+#endif
+#if MF_KEYMATRIX_SUPPORT == 1
+    ioScheduler.add(kTaskKeyMatrix, KeyMatrix::read, MF_KEYMATRIX_POLL_MS, 3, 1);
+#endif
+#if MF_OUTPUT_SHIFTER_SUPPORT == 1
+    scheduler.add(kTaskOutputShifters, OutputShifter::update, 0, 0, 3);
+#endif
+#if MF_LCD_SUPPORT == 1
+    ioScheduler.add(kTaskLcdDisplays, LCDDisplay::update, 0, 0, 3);
+#endif
+#if MF_SEGMENT_SUPPORT == 1
+    ioScheduler.add(kTaskSegments, LedSegment::update, 0, 0, 3);
 #endif
+#if MF_CUSTOMDEVICE_SUPPORT == 1 && defined(MF_CUSTOMDEVICE_HAS_UPDATE)
+#ifdef MF_CUSTOMDEVICE_POLL_MS
+    scheduler.add(kTaskCustomDevice, CustomDevice::update, MF_CUSTOMDEVICE_POLL_MS, 0, 3);
+#else
+    scheduler.add(kTaskCustomDevice, CustomDevice::update, 0, 0, 3);
+#endif
+#endif
+#if MF_ANALOG_SUPPORT == 1
+    ioScheduler.add(kTaskAnalogAverage, Analog::readAverage, MF_ANALOGAVERAGE_DELAY_MS, 4, 4);
+    ioScheduler.add(kTaskAnalog, Analog::read, MF_ANALOGREAD_DELAY_MS, 4, 4);
+    ioScheduler.add(kTaskAnalogMux, AnalogMux::read, MF_ANALOGMUX_POLL_MS, 1, 4);
+#endif
+    // outputs do not need update
 }
 
-void timedUpdate(void (*fun)(), uint32_t *last, uint8_t intv)
+void OnSetTaskTiming()
 {
-    if (millis() - *last >= intv) {
-        fun();
-        *last = millis();
+    uint8_t  task     = (uint8_t)cmdMessenger.readInt16Arg();
+    uint16_t period   = cmdMessenger.readInt16Arg();
+    uint16_t phase    = cmdMessenger.readInt16Arg();
+    uint8_t  priority = (uint8_t)cmdMessenger.readInt16Arg();
+    bool     success  = scheduler.setTiming(task, period, phase, priority);
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    // the input and display tasks are running on the 2nd core
+    if (!success)
+        success = IOCore::setTiming(task, period, phase, priority);
+#endif
+    if (success)
+        cmdMessenger.sendCmd(kStatus, F("OK"));
+    else
+        cmdMessenger.sendCmd(kStatus, F("Failure, task timing not set"));
+}
+
+// Reports the overruns and the max. delay of each task since the last request
+void OnGetTaskStats()
+{
+    uint8_t  id;
+    uint16_t overruns, maxLate;
+
+    cmdMessenger.sendCmdStart(kTaskStats);
+    for (uint8_t i = 0; scheduler.getStats(i, &id, &overruns, &maxLate); i++) {
+        cmdMessenger.sendCmdArg(id);
+        cmdMessenger.sendCmdArg(overruns);
+        cmdMessenger.sendCmdArg(maxLate);
     }
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    for (uint8_t i = 0; IOCore::scheduler.getStats(i, &id, &overruns, &maxLate); i++) {
+        cmdMessenger.sendCmdArg(id);
+        cmdMessenger.sendCmdArg(overruns);
+        cmdMessenger.sendCmdArg(maxLate);
+    }
+    IOCore::scheduler.resetStats();
+#endif
+    cmdMessenger.sendCmdEnd();
+    scheduler.resetStats();
 }
 
 // ************************************************************
@@ -170,8 +222,10 @@ void setup()
     MFeeprom.init();
     attachCommandCallbacks();
     cmdMessenger.printLfCr();
+    // the 2nd core starts running its tasks as soon as the config is activated,
+    // so all tasks must be registered before
+    initScheduler();
     ResetBoard();
-    initPollIntervals();
 }
 
 // ************************************************************
@@ -182,46 +236,22 @@ void loop()
     // Process incoming serial data, and perform callbacks
     cmdMessenger.feedinSerialData();
     updatePowerSaving();
-
-    // if config has been reset and still is not activated
-    // do not perform updates
-    // to prevent mangling input for config (shared buffers)
-    if (getStatusConfig()) {
-
-        timedUpdate(Button::read, &lastUpdate.Buttons, MF_BUTTON_DEBOUNCE_MS);
-
-        timedUpdate(Encoder::read, &lastUpdate.Encoders, MF_ENCODER_DEBOUNCE_MS);
-
-#if MF_STEPPER_SUPPORT == 1
-        Stepper::update();
+#if defined(IO_ON_2ND_CORE) && defined(ARDUINO_ARCH_RP2040)
+    // input events from the 2nd core
+    IOCore::sendEvents();
 #endif
 
-#if MF_SERVO_SUPPORT == 1
-        timedUpdate(Servos::update, &lastUpdate.Servos, MF_SERVO_DELAY_MS);
-#endif
-
-#if MF_ANALOG_SUPPORT == 1
-        timedUpdate(Analog::read, &lastUpdate.Analog, MF_ANALOGREAD_DELAY_MS);
-        timedUpdate(Analog::readAverage, &lastUpdate.AnalogAverage, MF_ANALOGAVERAGE_DELAY_MS);
-#endif
-
-#if MF_INPUT_SHIFTER_SUPPORT == 1
-        timedUpdate(InputShifter::read, &lastUpdate.InputShifters, MF_INSHIFTER_POLL_MS);
-#endif
-
-#if MF_DIGIN_MUX_SUPPORT == 1
-        timedUpdate(DigInMux::read, &lastUpdate.DigInMux, MF_INMUX_POLL_MS);
-#endif
-
-#if MF_CUSTOMDEVICE_SUPPORT == 1 && defined(MF_CUSTOMDEVICE_HAS_UPDATE)
-#ifdef MF_CUSTOMDEVICE_POLL_MS
-        timedUpdate(CustomDevice::update, &lastUpdate.CustomDevice, MF_CUSTOMDEVICE_POLL_MS);
-#else
-        CustomDevice::update();
-#endif
-#endif
-
-        // lcds, outputs, outputshifters, segments do not need update
+    // no updates before the first config is activated, afterwards the devices
+    // of the running config are updated also while a new config gets uploaded
+    if (getStatusConfig()) {
+        // deadlines have not been kept while the config was not active
+        if (!schedulerRunning) {
+            scheduler.restart();
+            schedulerRunning = true;
+        }
+        scheduler.run();
+    } else {
+        schedulerRunning = false;
     }
 }
 
@@ -12,4 +12,27 @@
 #include "allocateMem.h"
 #include "commandmessenger.h"
 
+// IDs of the scheduled tasks, used by kSetTaskTiming and kTaskStats
+enum {
+    kTaskEncoders,        // 0
+    kTaskButtons,         // 1
+    kTaskSteppers,        // 2
+    kTaskServos,          // 3
+    kTaskInputShifters,   // 4
+    kTaskDigInMux,        // 5
+    kTaskOutputShifters,  // 6
+    kTaskLcdDisplays,     // 7
+    kTaskSegments,        // 8
+    kTaskCustomDevice,    // 9
+    kTaskAnalogAverage,   // 10
+    kTaskAnalog,          // 11
+    kTaskDigInMuxCascade, // 12
+    kTaskAnalogMux,       // 13
+    kTaskKeyMatrix,       // 14
+    kTaskMax              // 15
+};
+
+void OnSetTaskTiming();
+void OnGetTaskStats();
+
 // mobiflight.h
\ No newline at end of file